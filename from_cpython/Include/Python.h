@@ -144,6 +144,10 @@ PyAPI_FUNC(PyObject*) _PyGC_GetGarbage(void) PYSTON_NOEXCEPT;
 // Pyston addition:
 PyAPI_FUNC(void) PyGC_Enable(void) PYSTON_NOEXCEPT;
 PyAPI_FUNC(void) PyGC_Disable(void) PYSTON_NOEXCEPT;
+// Freezes all objects currently tracked by the collector (see __pyston__.freeze()).  Returns how many there were.
+PyAPI_FUNC(Py_ssize_t) _PyGC_Freeze(void) PYSTON_NOEXCEPT;
+// Puts the frozen objects back into the oldest generation (only used at shutdown).
+PyAPI_FUNC(void) _PyGC_Unfreeze(void) PYSTON_NOEXCEPT;
 
 #ifdef Py_TRACE_REFS
 // This function is a semi-smart leak finder.  Using the cycle-collector
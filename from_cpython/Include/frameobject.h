@@ -98,6 +98,9 @@ PyAPI_FUNC(void) PyFrame_SetLineNumber(PyFrameObject *, int line_number) PYSTON_
 PyAPI_FUNC(BORROWED(PyObject *)) PyFrame_GetGlobals(PyFrameObject *) PYSTON_NOEXCEPT;
 // Pyston changes: add a function to get the code object
 PyAPI_FUNC(BORROWED(PyObject *)) PyFrame_GetCode(PyFrameObject *) PYSTON_NOEXCEPT;
+// Pyston changes: add functions to get and set the local trace function (f_trace)
+PyAPI_FUNC(BORROWED(PyObject *)) PyFrame_GetTrace(PyFrameObject *) PYSTON_NOEXCEPT;
+PyAPI_FUNC(void) PyFrame_SetTrace(PyFrameObject *, PyObject *) PYSTON_NOEXCEPT;
 // Pyston changes: add a function to get frame object by level
 PyAPI_FUNC(BORROWED(PyFrameObject *)) PyFrame_ForStackLevel(int stack_level) PYSTON_NOEXCEPT;
 
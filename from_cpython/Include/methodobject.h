@@ -27,6 +27,12 @@ typedef PyObject *(*PyCFunction)(PyObject *, PyObject *);
 typedef PyObject *(*PyCFunctionWithKeywords)(PyObject *, PyObject *,
 					     PyObject *);
 typedef PyObject *(*PyNoArgsFunction)(PyObject *);
+// Pyston addition: signatures for METH_FASTCALL and METH_FASTCALL | METH_KEYWORDS.
+// The values of the keyword arguments follow the nargs positional ones in the
+// array, and kwnames is a tuple of their names (NULL if there are none).
+typedef PyObject *(*_PyCFunctionFast)(PyObject *, PyObject *const *, Py_ssize_t);
+typedef PyObject *(*_PyCFunctionFastWithKeywords)(PyObject *, PyObject *const *,
+                                                  Py_ssize_t, PyObject *);
 
 PyAPI_FUNC(PyCFunction) PyCFunction_GetFunction(PyObject *) PYSTON_NOEXCEPT;
 PyAPI_FUNC(BORROWED(PyObject *)) PyCFunction_GetSelf(PyObject *) PYSTON_NOEXCEPT;
@@ -88,6 +94,11 @@ PyAPI_FUNC(PyObject *) PyCFunction_NewEx(PyMethodDef *, PyObject *,
 #define METH_D2        0x0400
 #define METH_D3        (METH_D1 | METH_D2)
 
+/* Pyston addition: the function gets its positional arguments as a C array
+   instead of a tuple, see _PyCFunctionFast.  Combine with METH_KEYWORDS to
+   also receive keyword arguments, see _PyCFunctionFastWithKeywords. */
+#define METH_FASTCALL  0x0800
+
 typedef struct PyMethodChain {
     PyMethodDef *methods;		/* Methods of this type */
     struct PyMethodChain *link;	/* NULL or base type */
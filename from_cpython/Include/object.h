@@ -806,6 +806,25 @@ PyAPI_FUNC(void) dec_count(PyTypeObject *) PYSTON_NOEXCEPT;
 #define _Py_COUNT_ALLOCS_COMMA
 #endif /* COUNT_ALLOCS */
 
+/* Pyston change: hooks for the sampled allocation profiler (see src/codegen/profiling/alloc_profiler.h).
+ * Every new object counts its basic size down from _PyAlloc_BytesUntilSample, and the one that makes it go negative
+ * gets sampled; while the profiler is off the counter stays far away from zero.  _PyAlloc_LiveFilter counts the
+ * sampled objects that are still alive per bucket of their memory block's address, so that freeing memory only has
+ * to look the block up when there are any live samples and the bucket isn't empty. */
+#define _PYALLOC_FILTER_SIZE (1 << 16)
+#define _PYALLOC_FILTER_IDX(p) ((((size_t)(p)) >> 4) & (_PYALLOC_FILTER_SIZE - 1))
+PyAPI_DATA(Py_ssize_t) _PyAlloc_BytesUntilSample;
+PyAPI_DATA(Py_ssize_t) _PyAlloc_NumLiveSamples;
+PyAPI_DATA(unsigned char) _PyAlloc_LiveFilter[_PYALLOC_FILTER_SIZE];
+PyAPI_FUNC(void) _PyAlloc_Sample(PyObject *) PYSTON_NOEXCEPT;
+PyAPI_FUNC(void) _PyAlloc_ForgetBlock(void *) PYSTON_NOEXCEPT;
+#define _PyAlloc_COUNT(op) \
+    (__builtin_expect((_PyAlloc_BytesUntilSample -= Py_TYPE(op)->tp_basicsize) < 0, 0) \
+         ? _PyAlloc_Sample((PyObject *)(op)) : (void)0)
+#define _PyAlloc_FREE(p) \
+    (__builtin_expect(_PyAlloc_NumLiveSamples != 0, 0) && _PyAlloc_LiveFilter[_PYALLOC_FILTER_IDX(p)] \
+         ? _PyAlloc_ForgetBlock(p) : (void)0)
+
 #ifdef Py_TRACE_REFS
 /* Py_TRACE_REFS is such major surgery that we call external routines. */
 PyAPI_FUNC(void) _Py_NewReference(PyObject *) PYSTON_NOEXCEPT;
@@ -825,7 +844,8 @@ PyAPI_FUNC(void) _Py_PrintReferenceAddressesCapped(FILE *, int) PYSTON_NOEXCEPT;
 #define _Py_NewReference(op) (                          \
     _Py_INC_TPALLOCS(op) _Py_COUNT_ALLOCS_COMMA         \
     _Py_INC_REFTOTAL  _Py_REF_DEBUG_COMMA               \
-    Py_REFCNT(op) = 1)
+    Py_REFCNT(op) = 1,                                  \
+    _PyAlloc_COUNT(op))
 
 #define _Py_ForgetReference(op) _Py_INC_TPFREES(op)
 
@@ -834,17 +854,53 @@ PyAPI_FUNC(void) _Py_PrintReferenceAddressesCapped(FILE *, int) PYSTON_NOEXCEPT;
     (*Py_TYPE(op)->tp_dealloc)((PyObject *)(op)))
 #endif /* !Py_TRACE_REFS */
 
-#define Py_INCREF(op) (                         \
-    _Py_INC_REFTOTAL  _Py_REF_DEBUG_COMMA       \
-    ((PyObject*)(op))->ob_refcnt++)
+/* Pyston change: immortal objects.
+ * Objects which stay alive until shutdown anyway (None, True/False, the interned small ints and strings, builtin
+ * types) get a refcount of at least _Py_IMMORTAL_REFCNT; they are never deallocated.  In normal builds
+ * Py_INCREF/Py_DECREF (as well as the JITs) then leave their refcount alone, which saves the memory writes and keeps
+ * these objects on pages which stay shared with the parent process after a fork().  Code which doesn't check (e.g.
+ * extensions compiled against an older header) only moves the refcount around a bit, which is harmless since it is
+ * nowhere close to zero.
+ * Py_REF_DEBUG builds need exact refcounts for the leak checks at shutdown, so there _Py_SetImmortal() adds
+ * _Py_IMMORTAL_REFCNT on top of the exact count and refcounting carries on as usual (_Py_IsPinned() is false);
+ * _Py_ReleaseImmortals() takes it off again during shutdown. */
+#define _Py_IMMORTAL_REFCNT ((Py_ssize_t)1 << 62)
+#define _Py_IsImmortal(op) (((PyObject*)(op))->ob_refcnt >= (_Py_IMMORTAL_REFCNT >> 1))
+#ifndef Py_REF_DEBUG
+#define _Py_SetImmortal(op) (((PyObject*)(op))->ob_refcnt = _Py_IMMORTAL_REFCNT)
+/* Whether refcount operations on an object with this refcount get skipped. */
+#define _Py_RefcntIsPinned(refcnt) ((refcnt) >= (_Py_IMMORTAL_REFCNT >> 1))
+#else
+PyAPI_FUNC(void) _Py_SetImmortalDebug(PyObject *) PYSTON_NOEXCEPT;
+PyAPI_FUNC(void) _Py_ReleaseImmortals(void) PYSTON_NOEXCEPT;
+#define _Py_SetImmortal(op) _Py_SetImmortalDebug((PyObject*)(op))
+#define _Py_RefcntIsPinned(refcnt) 0
+#endif
+#define _Py_IsPinned(op) _Py_RefcntIsPinned(((PyObject*)(op))->ob_refcnt)
+
+/* Py_INCREF and Py_DECREF evaluate op only once: callers do things like Py_INCREF(result = proxy).
+ * (This takes the refcount's address since PyObject is an incomplete type here when compiling the runtime.) */
+static inline void
+_Py_IncRefcnt(Py_ssize_t *refcnt)
+{
+    if (_Py_RefcntIsPinned(*refcnt))
+        return;
+    _Py_INC_REFTOTAL  _Py_REF_DEBUG_COMMA
+    (*refcnt)++;
+}
+
+#define Py_INCREF(op) _Py_IncRefcnt(&((PyObject *)(op))->ob_refcnt)
 
 #define Py_DECREF(op)                                   \
     do {                                                \
-        if (_Py_DEC_REFTOTAL  _Py_REF_DEBUG_COMMA       \
-        --((PyObject*)(op))->ob_refcnt != 0)            \
-            _Py_CHECK_REFCNT(op)                        \
+        PyObject *_py_decref_tmp = (PyObject *)(op);    \
+        if (_Py_IsPinned(_py_decref_tmp))               \
+            ;                                           \
+        else if (_Py_DEC_REFTOTAL  _Py_REF_DEBUG_COMMA  \
+        --(_py_decref_tmp)->ob_refcnt != 0)             \
+            _Py_CHECK_REFCNT(_py_decref_tmp)            \
         else                                            \
-        _Py_Dealloc((PyObject *)(op));                  \
+        _Py_Dealloc(_py_decref_tmp);                    \
     } while (0)
 
 /* Safely decref `op` and set `op` to NULL, especially useful in tp_clear
@@ -137,6 +137,72 @@ PyAPI_FUNC(void) _PyMem_DebugFree(void *p) PYSTON_NOEXCEPT;
 
 #endif  /* WITH_PYMALLOC */
 
+/* Pyston addition: the fast path of PyObject_Malloc (taking a block off the free list of a used pool
+ * for that size class, or off the pool's untouched space), so that it can get inlined into the
+ * callers that allocate most of our objects.  When the size is a compile-time constant this is just
+ * a few loads and stores.  Everything else (a pool filling up, a new pool being needed, large sizes,
+ * valgrind) goes through PyObject_Malloc.
+ * The pool layout is shared with obmalloc.c.
+ * Like the rest of pymalloc this relies on the GIL; there are no per-thread caches.  The llvm tier gets it
+ * inlined along with the allocating runtime functions from the stdlib bitcode, see _PyObject_GC_MallocFast.
+ * _PyObject_SizeClassFast/_PyObject_SizeClassSlow count, per size class, the allocations that took this
+ * path and the ones that went through PyObject_Malloc. */
+#ifdef WITH_PYMALLOC
+struct _Py_pool_header {
+    union { unsigned char *_padding;
+            unsigned int count; } ref;  /* number of allocated blocks    */
+    unsigned char *freeblock;           /* pool's free list head         */
+    struct _Py_pool_header *nextpool;   /* next pool of this size class  */
+    struct _Py_pool_header *prevpool;   /* previous pool       ""        */
+    unsigned int arenaindex;            /* index into arenas of base adr */
+    unsigned int szidx;                 /* block size class index        */
+    unsigned int nextoffset;            /* bytes to virgin block         */
+    unsigned int maxnextoffset;         /* largest valid nextoffset      */
+};
+PyAPI_DATA(struct _Py_pool_header *) _PyObject_UsedPools[];
+
+#define _PYMALLOC_ALIGNMENT_SHIFT 3
+#define _PYMALLOC_SMALL_REQUEST_THRESHOLD 512
+#define _PYMALLOC_NB_SIZE_CLASSES (_PYMALLOC_SMALL_REQUEST_THRESHOLD >> _PYMALLOC_ALIGNMENT_SHIFT)
+PyAPI_DATA(Py_ssize_t) _PyObject_SizeClassFast[_PYMALLOC_NB_SIZE_CLASSES];
+PyAPI_DATA(Py_ssize_t) _PyObject_SizeClassSlow[_PYMALLOC_NB_SIZE_CLASSES];
+#endif
+
+#if defined(WITH_PYMALLOC) && !defined(PYMALLOC_DEBUG)
+static inline void *
+_PyObject_MallocFast(size_t nbytes)
+{
+    if ((nbytes - 1) < _PYMALLOC_SMALL_REQUEST_THRESHOLD) {
+        unsigned int size = (unsigned int)(nbytes - 1) >> _PYMALLOC_ALIGNMENT_SHIFT;
+        struct _Py_pool_header *pool = _PyObject_UsedPools[size + size];
+        if (pool != pool->nextpool) {
+            /* Only handle the cases where the pool stays in use after
+             * this allocation; PyObject_Malloc deals with the rest. */
+            unsigned char *bp = pool->freeblock;
+            unsigned char *next = *(unsigned char **)bp;
+            if (next != NULL) {
+                pool->freeblock = next;
+                ++pool->ref.count;
+                ++_PyObject_SizeClassFast[size];
+                return bp;
+            }
+            if (pool->nextoffset <= pool->maxnextoffset) {
+                /* Carve the next block off the pool's untouched space. */
+                pool->freeblock = (unsigned char *)pool + pool->nextoffset;
+                pool->nextoffset += (size + 1) << _PYMALLOC_ALIGNMENT_SHIFT;
+                *(unsigned char **)pool->freeblock = NULL;
+                ++pool->ref.count;
+                ++_PyObject_SizeClassFast[size];
+                return bp;
+            }
+        }
+    }
+    return PyObject_Malloc(nbytes);
+}
+#else
+#define _PyObject_MallocFast    PyObject_MALLOC
+#endif
+
 #define PyObject_Del            PyObject_Free
 #define PyObject_DEL            PyObject_FREE
 
@@ -317,6 +383,38 @@ PyAPI_FUNC(void) PyObject_GC_Del(void *) PYSTON_NOEXCEPT;
 #define PyObject_GC_NewVar(type, typeobj, n) \
                 ( (type *) _PyObject_GC_NewVar((typeobj), (n)) )
 
+/* Pyston addition: the collector's generations, exported so that _PyObject_GC_MallocFast can tell
+ * whether an allocation is going to trigger a collection. */
+struct _Py_gc_generation {
+    PyGC_Head head;
+    int threshold; /* collection threshold */
+    int count; /* count of allocations or collections of younger
+                  generations */
+};
+PyAPI_DATA(struct _Py_gc_generation) _PyGC_generations[];
+
+/* Pyston addition: _PyObject_GC_Malloc for the common case that the allocation doesn't trigger a
+ * collection, on top of _PyObject_MallocFast.  Box::newFast uses it, so together with the runtime
+ * functions in the stdlib bitcode it gets inlined into the llvm tier's code. */
+#if defined(WITH_PYMALLOC) && !defined(PYMALLOC_DEBUG)
+static inline PyObject *
+_PyObject_GC_MallocFast(size_t basicsize)
+{
+    struct _Py_gc_generation *gen0 = &_PyGC_generations[0];
+    if (gen0->count < gen0->threshold) {
+        PyGC_Head *g = (PyGC_Head *)_PyObject_MallocFast(sizeof(PyGC_Head) + basicsize);
+        if (g != NULL) {
+            g->gc.gc_refs = _PyGC_REFS_UNTRACKED;
+            gen0->count++;
+            return (PyObject *)(g + 1);
+        }
+    }
+    return _PyObject_GC_Malloc(basicsize);
+}
+#else
+#define _PyObject_GC_MallocFast _PyObject_GC_Malloc
+#endif
+
 
 /* Utility macro to help write tp_traverse functions.
  * To use this macro, the tp_traverse function must name its arguments
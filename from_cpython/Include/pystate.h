@@ -86,9 +86,6 @@ typedef struct _ts {
     PyObject *async_exc; /* Asynchronous exception to raise */
     long thread_id; /* Thread id where this tstate was created */
 
-    // Pyston change:
-    // Pyston note: additions in here need to be mirrored in PyThreadState_Clear
-#if 0
     /* 'tracing' keeps track of the execution depth when tracing/profiling.
        This is to prevent the actual trace/profile code from being recorded in
        the trace/profile. */
@@ -100,6 +97,9 @@ typedef struct _ts {
     PyObject *c_profileobj;
     PyObject *c_traceobj;
 
+    // Pyston change:
+    // Pyston note: additions in here need to be mirrored in PyThreadState_Clear
+#if 0
     PyObject *exc_type;
     PyObject *exc_value;
     PyObject *exc_traceback;
@@ -439,15 +439,16 @@ profiler_callback(PyObject *self, PyFrameObject *frame, int what,
     switch (what) {
 
     /* the 'frame' of a called function is about to start its execution */
+    // Pyston change: our frame objects are opaque
     case PyTrace_CALL:
-        ptrace_enter_call(self, (void *)frame->f_code,
-                                (PyObject *)frame->f_code);
+        ptrace_enter_call(self, (void *)PyFrame_GetCode(frame),
+                                PyFrame_GetCode(frame));
         break;
 
     /* the 'frame' of a called function is about to finish
        (either normally or with an exception) */
     case PyTrace_RETURN:
-        ptrace_leave_call(self, (void *)frame->f_code);
+        ptrace_leave_call(self, (void *)PyFrame_GetCode(frame));
         break;
 
     /* case PyTrace_EXCEPTION:
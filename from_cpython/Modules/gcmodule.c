@@ -29,18 +29,15 @@
 
 /*** Global GC state ***/
 
-struct gc_generation {
-    PyGC_Head head;
-    int threshold; /* collection threshold */
-    int count; /* count of allocations or collections of younger
-                  generations */
-};
+/* Pyston change: struct gc_generation is shared with _PyObject_GC_MallocFast in objimpl.h. */
+#define gc_generation _Py_gc_generation
 
 #define NUM_GENERATIONS 3
 #define GEN_HEAD(n) (&generations[n].head)
 
 /* linked lists of container objects */
-static struct gc_generation generations[NUM_GENERATIONS] = {
+#define generations _PyGC_generations
+struct gc_generation generations[NUM_GENERATIONS] = {
     /* PyGC_Head,                               threshold,      count */
     {{{GEN_HEAD(0), GEN_HEAD(0), 0}},           700,            0},
     {{{GEN_HEAD(1), GEN_HEAD(1), 0}},           10,             0},
@@ -1534,6 +1531,70 @@ PyGC_Collect(void)
     return n;
 }
 
+// Pyston addition: objects frozen by _PyGC_Freeze().  Collections never look at this list.
+static PyGC_Head permanent_generation = {{&permanent_generation, &permanent_generation, 0}};
+
+static void
+freeze_object(PyObject *op)
+{
+    /* Compute the cached hashes now, rather than writing them into
+     * shared pages later. */
+    if (PyString_CheckExact(op) || PyUnicode_CheckExact(op)) {
+        if (PyObject_Hash(op) == -1)
+            PyErr_Clear();
+    }
+    _Py_SetImmortal(op);
+}
+
+static int
+visit_freeze(PyObject *op, void *data)
+{
+    if (op == NULL || _Py_IsImmortal(op))
+        return 0;
+    if (PyObject_IS_GC(op) && IS_TRACKED(op))
+        return 0; /* gets frozen when we reach it in its generation */
+    freeze_object(op);
+    /* untracked containers only hold atomic objects, so this doesn't
+     * recurse far */
+    if (PyObject_IS_GC(op))
+        (void) Py_TYPE(op)->tp_traverse(op, (visitproc)visit_freeze, NULL);
+    return 0;
+}
+
+// Pyston addition: make every object tracked by the collector (and the untracked objects they
+// directly refer to) immortal, and move them out of the generations so that collections don't
+// touch them anymore either.  Meant to be called right before fork()ing worker processes, so that
+// these objects stay on pages shared with the parent.  Frozen objects are never freed.
+Py_ssize_t
+_PyGC_Freeze(void)
+{
+    int i;
+    Py_ssize_t n = 0;
+    PyGC_Head *gc;
+
+    for (i = 0; i < NUM_GENERATIONS; i++) {
+        for (gc = GEN_HEAD(i)->gc.gc_next; gc != GEN_HEAD(i); gc = gc->gc.gc_next) {
+            PyObject *op = FROM_GC(gc);
+            freeze_object(op);
+            (void) Py_TYPE(op)->tp_traverse(op, (visitproc)visit_freeze, NULL);
+            n++;
+        }
+        gc_list_merge(GEN_HEAD(i), &permanent_generation);
+        generations[i].count = 0;
+    }
+    long_lived_total = 0;
+    long_lived_pending = 0;
+    return n;
+}
+
+// Pyston addition: hand the frozen objects back to the collector.  Only meant for shutdown in
+// Py_REF_DEBUG builds, after _Py_ReleaseImmortals(), so that the leak checks can account for them.
+void
+_PyGC_Unfreeze(void)
+{
+    gc_list_merge(&permanent_generation, GEN_HEAD(NUM_GENERATIONS - 1));
+}
+
 /* for debugging */
 void
 _PyGC_Dump(PyGC_Head *g)
@@ -1586,7 +1647,7 @@ _PyObject_GC_Malloc(size_t basicsize)
     PyGC_Head *g;
     if (basicsize > PY_SSIZE_T_MAX - sizeof(PyGC_Head))
         return PyErr_NoMemory();
-    g = (PyGC_Head *)PyObject_MALLOC(
+    g = (PyGC_Head *)_PyObject_MallocFast(
         sizeof(PyGC_Head) + basicsize);
     if (g == NULL)
         return PyErr_NoMemory();
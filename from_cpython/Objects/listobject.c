@@ -984,6 +984,26 @@ reverse_slice(PyObject **lo, PyObject **hi)
  * pieces to this algorithm; read listsort.txt for overviews and details.
  */
 
+/* Pyston change: the sort helpers take a sortcompare instead of the user's
+ * comparison function, so that listsort() can swap in a specialized "<" when
+ * all the keys have the same exact type.
+ */
+typedef struct s_sortcompare sortcompare;
+typedef int (*sortltfunc)(PyObject *x, PyObject *y, sortcompare *compare);
+
+struct s_sortcompare {
+    /* Returns -1 on error, 1 if x < y, 0 if x >= y.  NULL means to use
+       PyObject_RichCompareBool with Py_LT. */
+    sortltfunc lt;
+
+    /* The user-supplied comparison function. or NULL if none given. */
+    PyObject *func;
+
+    /* Nonzero if the items are sortwrappers; the specialized comparisons
+       then compare their keys. */
+    int unwrap_keys;
+};
+
 /* Comparison function.  Takes care of calling a user-supplied
  * comparison function (any callable Python object), which must not be
  * NULL (use the ISLT macro if you don't know, or call PyObject_RichCompareBool
@@ -991,11 +1011,12 @@ reverse_slice(PyObject **lo, PyObject **hi)
  * Returns -1 on error, 1 if x < y, 0 if x >= y.
  */
 static int
-islt(PyObject *x, PyObject *y, PyObject *compare)
+islt(PyObject *x, PyObject *y, sortcompare *sc)
 {
     PyObject *res;
     PyObject *args;
     Py_ssize_t i;
+    PyObject *compare = sc->func;
 
     assert(compare != NULL);
     /* Call the user's comparison function and translate the 3-way
@@ -1024,14 +1045,14 @@ islt(PyObject *x, PyObject *y, PyObject *compare)
     return i < 0;
 }
 
-/* If COMPARE is NULL, calls PyObject_RichCompareBool with Py_LT, else calls
- * islt.  This avoids a layer of function call in the usual case, and
- * sorting does many comparisons.
+/* If COMPARE->lt is NULL, calls PyObject_RichCompareBool with Py_LT, else
+ * calls COMPARE->lt.  This avoids a layer of function call in the usual case,
+ * and sorting does many comparisons.
  * Returns -1 on error, 1 if x < y, 0 if x >= y.
  */
-#define ISLT(X, Y, COMPARE) ((COMPARE) == NULL ?                        \
+#define ISLT(X, Y, COMPARE) ((COMPARE)->lt == NULL ?                    \
                  PyObject_RichCompareBool(X, Y, Py_LT) :                \
-                 islt(X, Y, COMPARE))
+                 (COMPARE)->lt(X, Y, COMPARE))
 
 /* Compare X to Y via "<".  Goto "fail" if the comparison raises an
    error.  Else "k" is set to true iff X<Y, and an "if (k)" block is
@@ -1052,8 +1073,7 @@ islt(PyObject *x, PyObject *y, PyObject *compare)
    the input (nothing is lost or duplicated).
 */
 static int
-binarysort(PyObject **lo, PyObject **hi, PyObject **start, PyObject *compare)
-     /* compare -- comparison function object, or NULL for default */
+binarysort(PyObject **lo, PyObject **hi, PyObject **start, sortcompare *compare)
 {
     register Py_ssize_t k;
     register PyObject **l, **p, **r;
@@ -1118,7 +1138,7 @@ elements to get out of order).
 Returns -1 in case of error.
 */
 static Py_ssize_t
-count_run(PyObject **lo, PyObject **hi, PyObject *compare, int *descending)
+count_run(PyObject **lo, PyObject **hi, sortcompare *compare, int *descending)
 {
     Py_ssize_t k;
     Py_ssize_t n;
@@ -1173,7 +1193,7 @@ key, and the last n-k should follow key.
 Returns -1 on error.  See listsort.txt for info on the method.
 */
 static Py_ssize_t
-gallop_left(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint, PyObject *compare)
+gallop_left(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint, sortcompare *compare)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1264,7 +1284,7 @@ we're sticking to "<" comparisons that it's much harder to follow if
 written as one routine with yet another "left or right?" flag.
 */
 static Py_ssize_t
-gallop_right(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint, PyObject *compare)
+gallop_right(PyObject *key, PyObject **a, Py_ssize_t n, Py_ssize_t hint, sortcompare *compare)
 {
     Py_ssize_t ofs;
     Py_ssize_t lastofs;
@@ -1365,8 +1385,8 @@ struct s_slice {
 };
 
 typedef struct s_MergeState {
-    /* The user-supplied comparison function. or NULL if none given. */
-    PyObject *compare;
+    /* How to compare two items. */
+    sortcompare *compare;
 
     /* This controls when we get *into* galloping mode.  It's initialized
      * to MIN_GALLOP.  merge_lo and merge_hi tend to nudge it higher for
@@ -1398,7 +1418,7 @@ typedef struct s_MergeState {
 
 /* Conceptually a MergeState's constructor. */
 static void
-merge_init(MergeState *ms, PyObject *compare)
+merge_init(MergeState *ms, sortcompare *compare)
 {
     assert(ms != NULL);
     ms->compare = compare;
@@ -1462,7 +1482,7 @@ merge_lo(MergeState *ms, PyObject **pa, Py_ssize_t na,
                          PyObject **pb, Py_ssize_t nb)
 {
     Py_ssize_t k;
-    PyObject *compare;
+    sortcompare *compare;
     PyObject **dest;
     int result = -1;            /* guilty until proved innocent */
     Py_ssize_t min_gallop;
@@ -1594,7 +1614,7 @@ static Py_ssize_t
 merge_hi(MergeState *ms, PyObject **pa, Py_ssize_t na, PyObject **pb, Py_ssize_t nb)
 {
     Py_ssize_t k;
-    PyObject *compare;
+    sortcompare *compare;
     PyObject **dest;
     int result = -1;            /* guilty until proved innocent */
     PyObject **basea;
@@ -1734,7 +1754,7 @@ merge_at(MergeState *ms, Py_ssize_t i)
     PyObject **pa, **pb;
     Py_ssize_t na, nb;
     Py_ssize_t k;
-    PyObject *compare;
+    sortcompare *compare;
 
     assert(ms != NULL);
     assert(ms->n >= 2);
@@ -2041,6 +2061,66 @@ build_cmpwrapper(PyObject *cmpfunc)
     return (PyObject *)co;
 }
 
+/* Pyston change: specialized "<" for lists whose keys all have the same
+   exact type.  None of these can run Python code, so they can neither fail
+   nor see the list while it is being sorted. */
+
+#define SORT_KEY(X, COMPARE) ((COMPARE)->unwrap_keys ?                 \
+                              ((sortwrapperobject *)(X))->key : (X))
+
+static int
+int_lt(PyObject *x, PyObject *y, sortcompare *compare)
+{
+    return PyInt_AS_LONG(SORT_KEY(x, compare)) < PyInt_AS_LONG(SORT_KEY(y, compare));
+}
+
+static int
+float_lt(PyObject *x, PyObject *y, sortcompare *compare)
+{
+    return PyFloat_AS_DOUBLE(SORT_KEY(x, compare)) < PyFloat_AS_DOUBLE(SORT_KEY(y, compare));
+}
+
+static int
+string_lt(PyObject *x, PyObject *y, sortcompare *compare)
+{
+    Py_ssize_t len_x, len_y;
+    int c;
+
+    x = SORT_KEY(x, compare);
+    y = SORT_KEY(y, compare);
+    len_x = PyString_GET_SIZE(x);
+    len_y = PyString_GET_SIZE(y);
+    c = memcmp(PyString_AS_STRING(x), PyString_AS_STRING(y),
+               len_x < len_y ? len_x : len_y);
+    return c != 0 ? c < 0 : len_x < len_y;
+}
+
+/* Returns a specialized comparison if every key in items[0:n] has the same
+   exact type and we have one for it, else NULL. */
+static sortltfunc
+specialized_lt(PyObject **items, Py_ssize_t n, sortcompare *compare)
+{
+    PyTypeObject *type;
+    Py_ssize_t i;
+
+    assert(n > 0);
+    type = Py_TYPE(SORT_KEY(items[0], compare));
+    for (i = 1; i < n; i++) {
+        if (Py_TYPE(SORT_KEY(items[i], compare)) != type)
+            return NULL;
+    }
+
+    if (type == &PyInt_Type)
+        return int_lt;
+    if (type == &PyFloat_Type)
+        return float_lt;
+    if (type == &PyString_Type)
+        return string_lt;
+    return NULL;
+}
+
+#undef SORT_KEY
+
 /* An adaptive, stable, natural mergesort.  See listsort.txt.
  * Returns Py_None on success, NULL on error.  Even in case of error, the
  * list will be some permutation of its input state (nothing is lost or
@@ -2051,6 +2131,7 @@ PyObject *
 listsort(PyListObject *self, PyObject *args, PyObject *kwds)
 {
     MergeState ms;
+    sortcompare sc;
     PyObject **lo, **hi;
     Py_ssize_t nremaining;
     Py_ssize_t minrun;
@@ -2124,7 +2205,14 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
     if (reverse && saved_ob_size > 1)
         reverse_slice(saved_ob_item, saved_ob_item + saved_ob_size);
 
-    merge_init(&ms, compare);
+    /* Pyston change: use a specialized comparison if the keys allow it. */
+    sc.func = compare;
+    sc.unwrap_keys = keyfunc != NULL;
+    sc.lt = compare != NULL ? islt : NULL;
+    if (compare == NULL && saved_ob_size > 1)
+        sc.lt = specialized_lt(saved_ob_item, saved_ob_size, &sc);
+
+    merge_init(&ms, &sc);
 
     nremaining = saved_ob_size;
     if (nremaining < 2)
@@ -2141,7 +2229,7 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
         Py_ssize_t n;
 
         /* Identify next run. */
-        n = count_run(lo, hi, compare, &descending);
+        n = count_run(lo, hi, &sc, &descending);
         if (n < 0)
             goto fail;
         if (descending)
@@ -2150,7 +2238,7 @@ listsort(PyListObject *self, PyObject *args, PyObject *kwds)
         if (n < minrun) {
             const Py_ssize_t force = nremaining <= minrun ?
                               nremaining : minrun;
-            if (binarysort(lo, lo + force, lo + n, compare) < 0)
+            if (binarysort(lo, lo + force, lo + n, &sc) < 0)
                 goto fail;
             n = force;
         }
@@ -263,18 +263,9 @@ static int running_on_valgrind = -1;
 /* When you say memory, my mind reasons in terms of (pointers to) blocks */
 typedef uchar block;
 
-/* Pool for small blocks. */
-struct pool_header {
-    union { block *_padding;
-            uint count; } ref;          /* number of allocated blocks    */
-    block *freeblock;                   /* pool's free list head         */
-    struct pool_header *nextpool;       /* next pool of this size class  */
-    struct pool_header *prevpool;       /* previous pool       ""        */
-    uint arenaindex;                    /* index into arenas of base adr */
-    uint szidx;                         /* block size class index        */
-    uint nextoffset;                    /* bytes to virgin block         */
-    uint maxnextoffset;                 /* largest valid nextoffset      */
-};
+/* Pool for small blocks.
+ * Pyston change: this is defined in objimpl.h, for _PyObject_MallocFast. */
+#define pool_header _Py_pool_header
 
 typedef struct pool_header *poolp;
 
@@ -441,7 +432,14 @@ the prevpool member.
 #define PTA(x)  ((poolp )((uchar *)&(usedpools[2*(x)]) - 2*sizeof(block *)))
 #define PT(x)   PTA(x), PTA(x)
 
-static poolp usedpools[2 * ((NB_SMALL_SIZE_CLASSES + 7) / 8) * 8] = {
+/* Pyston change: exported for _PyObject_MallocFast (see objimpl.h) */
+#if ALIGNMENT_SHIFT != _PYMALLOC_ALIGNMENT_SHIFT || SMALL_REQUEST_THRESHOLD != _PYMALLOC_SMALL_REQUEST_THRESHOLD
+#error "objimpl.h's copy of the size class parameters is out of date"
+#endif
+#define usedpools _PyObject_UsedPools
+Py_ssize_t _PyObject_SizeClassFast[NB_SMALL_SIZE_CLASSES];
+Py_ssize_t _PyObject_SizeClassSlow[NB_SMALL_SIZE_CLASSES];
+poolp usedpools[2 * ((NB_SMALL_SIZE_CLASSES + 7) / 8) * 8] = {
     PT(0), PT(1), PT(2), PT(3), PT(4), PT(5), PT(6), PT(7)
 #if NB_SMALL_SIZE_CLASSES > 8
     , PT(8), PT(9), PT(10), PT(11), PT(12), PT(13), PT(14), PT(15)
@@ -797,6 +795,7 @@ PyObject_Malloc(size_t nbytes)
          * Most frequent paths first
          */
         size = (uint)(nbytes - 1) >> ALIGNMENT_SHIFT;
+        ++_PyObject_SizeClassSlow[size];
         pool = usedpools[size + size];
         if (LIKELY(pool != pool->nextpool)) {
             /*
@@ -993,6 +992,9 @@ PyObject_Free(void *p)
     if (p == NULL)      /* free(NULL) has no effect */
         return;
 
+    /* Pyston change: let the allocation profiler know in case this was a sampled object. */
+    _PyAlloc_FREE(p);
+
 #ifdef WITH_VALGRIND
     if (UNLIKELY(running_on_valgrind > 0))
         goto redirect;
@@ -1231,6 +1233,9 @@ PyObject_Realloc(void *p, size_t nbytes)
     if (nbytes > PY_SSIZE_T_MAX)
         return NULL;
 
+    /* Pyston change: the object (if there was one) is gone, even if the block stays where it is. */
+    _PyAlloc_FREE(p);
+
 #ifdef WITH_VALGRIND
     /* Treat running_on_valgrind == -1 the same as 0 */
     if (UNLIKELY(running_on_valgrind > 0))
@@ -1304,12 +1309,18 @@ PyObject_Malloc(size_t n)
 void *
 PyObject_Realloc(void *p, size_t n)
 {
+    /* Pyston change: */
+    if (p != NULL)
+        _PyAlloc_FREE(p);
     return PyMem_REALLOC(p, n);
 }
 
 void
 PyObject_Free(void *p)
 {
+    /* Pyston change: */
+    if (p != NULL)
+        _PyAlloc_FREE(p);
     PyMem_FREE(p);
 }
 #endif /* WITH_PYMALLOC */
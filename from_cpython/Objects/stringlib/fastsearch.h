@@ -33,6 +33,109 @@
 #define STRINGLIB_BLOOM(mask, ch)     \
     ((mask &  (1UL << ((ch) & (STRINGLIB_BLOOM_WIDTH -1)))))
 
+// Pyston change: vectorized kernels for byte strings.  SSE2 is part of the
+// x86-64 baseline, so these need no runtime dispatch; the single-byte searches
+// go through memchr/memrchr, which glibc already dispatches to its AVX2/EVEX
+// implementations at load time.
+#if !STRINGLIB_IS_UNICODE && defined(__SSE2__)
+#define STRINGLIB_USE_SSE2 1
+
+#include <emmintrin.h>
+#include <string.h>
+
+/* needles longer than this go through the horspool search below, which
+   degrades more gracefully on repetitive input */
+#define STRINGLIB_SSE2_MAX_NEEDLE 32
+
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_count_char(const char* s, Py_ssize_t n, char ch, Py_ssize_t maxcount)
+{
+    const __m128i needle = _mm_set1_epi8(ch);
+    Py_ssize_t i = 0, count = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(s + i));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        if (count >= maxcount)
+            return maxcount;
+    }
+    for (; i < n; i++)
+        if (s[i] == ch) {
+            count++;
+            if (count == maxcount)
+                return maxcount;
+        }
+    return count;
+}
+
+/* Compares the first and last byte of the needle against 16 positions at a
+   time and only verifies the candidates where both match.  Requires m >= 2. */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_find_sse2(const char* s, Py_ssize_t n, const char* p, Py_ssize_t m)
+{
+    const __m128i first = _mm_set1_epi8(p[0]);
+    const __m128i last = _mm_set1_epi8(p[m - 1]);
+    Py_ssize_t i = 0;
+
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(s + i + m - 1));
+        unsigned int mask = _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(s + i + bit + 1, p + 1, m - 2) == 0)
+                return i + bit;
+            mask &= mask - 1;
+        }
+    }
+    for (; i + m <= n; i++)
+        if (s[i] == p[0] && s[i + m - 1] == p[m - 1] && memcmp(s + i + 1, p + 1, m - 2) == 0)
+            return i;
+    return -1;
+}
+
+/* Returns the index of the first '\n' or '\r' at or after i, or n. */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_find_linebreak(const char* s, Py_ssize_t i, Py_ssize_t n)
+{
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(s + i));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, nl), _mm_cmpeq_epi8(block, cr)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    while (i < n && s[i] != '\n' && s[i] != '\r')
+        i++;
+    return i;
+}
+
+/* Returns the index of the first Py_ISSPACE byte at or after i, or n.
+   Py_ISSPACE is true for ' ' and for '\t' through '\r' (9-13). */
+Py_LOCAL_INLINE(Py_ssize_t)
+stringlib_find_space(const char* s, Py_ssize_t i, Py_ssize_t n)
+{
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i four = _mm_set1_epi8(4);
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(s + i));
+        __m128i d = _mm_sub_epi8(block, tab);
+        __m128i ctrl = _mm_cmpeq_epi8(_mm_min_epu8(d, four), d);
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, space), ctrl));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    while (i < n && !Py_ISSPACE(s[i]))
+        i++;
+    return i;
+}
+#endif
+
 Py_LOCAL_INLINE(Py_ssize_t)
 fastsearch(const STRINGLIB_CHAR* s, Py_ssize_t n,
            const STRINGLIB_CHAR* p, Py_ssize_t m,
@@ -51,6 +154,17 @@ fastsearch(const STRINGLIB_CHAR* s, Py_ssize_t n,
     if (m <= 1) {
         if (m <= 0)
             return -1;
+#ifdef STRINGLIB_USE_SSE2
+        if (mode == FAST_COUNT) {
+            return stringlib_count_char(s, n, p[0], maxcount);
+        } else if (mode == FAST_SEARCH) {
+            const char* found = (const char*)memchr(s, p[0], n);
+            return found ? found - s : -1;
+        } else {
+            const char* found = (const char*)memrchr(s, p[0], n);
+            return found ? found - s : -1;
+        }
+#endif
         /* use special case for 1-character strings */
         if (mode == FAST_COUNT) {
             for (i = 0; i < n; i++)
@@ -72,6 +186,22 @@ fastsearch(const STRINGLIB_CHAR* s, Py_ssize_t n,
         return -1;
     }
 
+#ifdef STRINGLIB_USE_SSE2
+    if (mode != FAST_RSEARCH && m <= STRINGLIB_SSE2_MAX_NEEDLE) {
+        if (mode == FAST_SEARCH)
+            return stringlib_find_sse2(s, n, p, m);
+
+        i = 0;
+        while ((j = stringlib_find_sse2(s + i, n - i, p, m)) >= 0) {
+            count++;
+            if (count == maxcount)
+                return maxcount;
+            i += j + m;
+        }
+        return count;
+    }
+#endif
+
     mlast = m - 1;
     skip = mlast - 1;
     mask = 0;
@@ -71,8 +71,12 @@ stringlib_split_whitespace(PyObject* str_obj,
             i++;
         if (i == str_len) break;
         j = i; i++;
+#ifdef STRINGLIB_USE_SSE2
+        i = stringlib_find_space(str, i, str_len);
+#else
         while (i < str_len && !STRINGLIB_ISSPACE(str[i]))
             i++;
+#endif
 #ifndef STRINGLIB_MUTABLE
         if (j == 0 && i == str_len && STRINGLIB_CHECK_EXACT(str_obj)) {
             /* No whitespace in str_obj, so just use it as list[0] */
@@ -360,8 +364,12 @@ stringlib_splitlines(PyObject* str_obj,
         Py_ssize_t eol;
 
         /* Find a line and append it */
+#ifdef STRINGLIB_USE_SSE2
+        i = stringlib_find_linebreak(str, i, str_len);
+#else
         while (i < str_len && !STRINGLIB_ISLINEBREAK(str[i]))
             i++;
+#endif
 
         /* Skip the line break reading CRLF as one line break */
         eol = i;
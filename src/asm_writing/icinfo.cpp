@@ -18,11 +18,13 @@
 #include <memory>
 
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/Twine.h"
 #include "llvm/Support/Memory.h"
 
 #include "asm_writing/assembler.h"
 #include "asm_writing/mc_writer.h"
 #include "codegen/patchpoints.h"
+#include "codegen/profiling/jitdump.h"
 #include "codegen/type_recording.h"
 #include "codegen/unwinding.h"
 #include "core/common.h"
@@ -83,6 +85,7 @@ void ICSlotInfo::clear(bool should_invalidate) {
     if (should_invalidate)
         ic->invalidate(this);
     used = false;
+    guarded_classes.clear();
 
     // Have to be careful here: DECREF can end up recursively clearing this slot
     std::vector<void*> saved_gc_references;
@@ -131,6 +134,7 @@ void ICSlotRewrite::abort() {
     auto ic = getICInfo();
     ic->retry_backoff = std::min(MAX_RETRY_BACKOFF, 2 * ic->retry_backoff);
     ic->retry_in = ic->retry_backoff;
+    ic->times_aborted++;
 }
 
 
@@ -220,6 +224,7 @@ void ICSlotRewrite::commit(CommitHook* hook, std::vector<void*> gc_references,
     ic_entry->clear(false /* don't invalidate */);
 
     ic_entry->gc_references = std::move(gc_references);
+    ic_entry->guarded_classes = std::move(guarded_classes);
     ic_entry->used = true;
     ic->times_rewritten++;
 
@@ -249,6 +254,20 @@ void ICSlotRewrite::commit(CommitHook* hook, std::vector<void*> gc_references,
     }
 
     llvm::sys::Memory::InvalidateInstructionCache(slot_start, original_size);
+
+    // The baseline jit commits whole fragments through here; it describes those itself (they are the only ICs
+    // without a continue address).
+    if (PERF_JITDUMP && ic->continue_addr) {
+        // Name the slot after the code it belongs to, so samples in it don't all land in one 'ic:getattr' bucket.
+        BoxedCode* code = ic->getCode();
+        std::string name;
+        if (code && code->name && code->filename)
+            name = ("ic:" + llvm::Twine(debug_name) + " " + code->name->s() + " (" + code->filename->s() + ":"
+                    + llvm::Twine(ic->getLineno()) + ")").str();
+        else
+            name = std::string("ic:") + debug_name;
+        jitdumpCodeLoad(name, slot_start, ic_entry->size);
+    }
 }
 
 void ICSlotRewrite::addDependenceOn(ICInvalidator& invalidator) {
@@ -289,6 +308,7 @@ int ICInfo::calculateSuggestedSize() {
 }
 
 std::unique_ptr<ICSlotRewrite> ICInfo::startRewrite(const char* debug_name) {
+    last_debug_name = debug_name;
     return ICSlotRewrite::create(this, debug_name);
 }
 
@@ -354,9 +374,16 @@ ICInfo::ICInfo(void* start_addr, void* slowpath_rtn_addr, void* continue_addr, S
       retry_in(0),
       retry_backoff(1),
       times_rewritten(0),
+      times_slowpath(0),
+      times_aborted(0),
+      last_debug_name(NULL),
       allocatable_registers(allocatable_registers),
       ic_global_decref_locations(std::move(ic_global_decref_locations)),
       node(NULL),
+      recorded_callee(NULL),
+      callee_polymorphic(false),
+      code(NULL),
+      lineno(-1),
       start_addr(start_addr),
       slowpath_rtn_addr(slowpath_rtn_addr),
       continue_addr(continue_addr) {
@@ -375,6 +402,40 @@ ICInfo::~ICInfo() {
         // Calling a full clear() might be overkill here, but probably better safe than sorry:
         slot.clear(false);
     }
+
+    Py_XDECREF(recorded_callee);
+}
+
+void ICInfo::recordCallee(Box* callee) {
+    if (callee_polymorphic)
+        return;
+
+    if (recorded_callee) {
+        if (PyWeakref_GET_OBJECT(recorded_callee) != callee) {
+            callee_polymorphic = true;
+            Py_CLEAR(recorded_callee);
+        }
+        return;
+    }
+
+    // Only Python functions can get called directly, so there's no point in tracking anything else.
+    if (callee->cls != function_cls) {
+        callee_polymorphic = true;
+        return;
+    }
+
+    recorded_callee = PyWeakref_NewRef(callee, NULL);
+    if (!recorded_callee) {
+        PyErr_Clear();
+        callee_polymorphic = true;
+    }
+}
+
+Box* ICInfo::getMonomorphicCallee() const {
+    if (callee_polymorphic || !recorded_callee)
+        return NULL;
+    Box* callee = PyWeakref_GET_OBJECT(recorded_callee);
+    return callee == Py_None ? NULL : callee;
 }
 
 DecrefInfo::DecrefInfo(uint64_t ip, std::vector<Location> locations) : ip(ip) {
@@ -436,6 +497,14 @@ ICInfo* getICInfo(void* rtn_addr) {
     return it->second;
 }
 
+std::vector<ICInfo*> getAllICInfos() {
+    std::vector<ICInfo*> rtn;
+    rtn.reserve(ics_by_return_addr.size());
+    for (auto&& p : ics_by_return_addr)
+        rtn.push_back(p.second);
+    return rtn;
+}
+
 void ICInfo::invalidate(ICSlotInfo* icentry) {
     assert(icentry);
 
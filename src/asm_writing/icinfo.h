@@ -15,8 +15,10 @@
 #ifndef PYSTON_ASMWRITING_ICINFO_H
 #define PYSTON_ASMWRITING_ICINFO_H
 
+#include <algorithm>
 #include <list>
 #include <memory>
+#include <string>
 #include <unordered_set>
 #include <vector>
 
@@ -30,6 +32,7 @@
 
 namespace pyston {
 
+class BoxedCode;
 class TypeRecorder;
 
 class ICInfo;
@@ -73,6 +76,9 @@ public:
     int size;
     bool used; // if this slot is empty or got invalidated
 
+    // The names of the classes that this slot's cls guards check for; only kept for introspection.
+    std::vector<std::string> guarded_classes;
+
     void clear(bool should_invalidate = true);
 };
 
@@ -96,6 +102,10 @@ private:
     std::unique_ptr<TypeRecorder> type_recorder;
     int retry_in, retry_backoff;
     int times_rewritten;
+    // How often the slowpath got entered (ie the IC missed), and how many rewrites got aborted:
+    int64_t times_slowpath;
+    int times_aborted;
+    const char* last_debug_name; // of the last rewrite attempt
     assembler::RegisterSet allocatable_registers;
 
     DecrefInfo slowpath_decref_info;
@@ -107,6 +117,16 @@ private:
     // associated BST node for this IC
     BST_stmt* node;
 
+    // Call-site feedback for runtimeCall ICs: the Python function the IC got rewritten for, as long as it was always the
+    // same one.  This is a weak reference, so that the IC doesn't keep the callee (and its globals) alive.  The llvm
+    // tier uses this to emit direct calls.
+    Box* recorded_callee;
+    bool callee_polymorphic;
+
+    // Where this IC is, for introspection.  Not set for the ICs of the runtime (runtime/ics.cpp).
+    BoxedCode* code;
+    int lineno;
+
     // for ICSlotRewrite:
     ICSlotInfo* pickEntryForRewrite(const char* debug_name);
 
@@ -141,10 +161,28 @@ public:
     int percentBackedoff() const { return retry_backoff; }
     int timesRewritten() const { return times_rewritten; }
 
+    // For introspection:
+    void noteSlowpathEntry() { times_slowpath++; }
+    int64_t timesSlowpath() const { return times_slowpath; }
+    int timesAborted() const { return times_aborted; }
+    int retryIn() const { return retry_in; }
+    const char* lastDebugName() const { return last_debug_name; }
+    const std::list<ICSlotInfo>& getSlots() const { return slots; }
+    void setLocation(BoxedCode* code, int lineno) {
+        this->code = code;
+        this->lineno = lineno;
+    }
+    BoxedCode* getCode() const { return code; }
+    int getLineno() const { return lineno; }
+
     assembler::RegisterSet getAllocatableRegs() const { return allocatable_registers; }
 
     friend class ICSlotRewrite;
 
+    void recordCallee(Box* callee);
+    // Returns a borrowed reference, or NULL if there is no single callee or it has been freed.
+    Box* getMonomorphicCallee() const;
+
     static ICInfo* getICInfoForNode(BST_stmt* node);
     void associateNodeWithICInfo(BST_stmt* node, std::unique_ptr<TypeRecorder> type_recorder);
 
@@ -167,6 +205,7 @@ private:
     uint8_t* buf;
     assembler::Assembler assembler;
     llvm::SmallVector<std::pair<ICInvalidator*, int64_t>, 4> dependencies;
+    std::vector<std::string> guarded_classes;
 
     ICSlotRewrite(ICSlotInfo* ic_entry, const char* debug_name);
 
@@ -191,6 +230,10 @@ public:
     ICSlotInfo* prepareEntry() { return (ic_entry && ic_entry->num_inside == 1) ? ic_entry : NULL; }
 
     void addDependenceOn(ICInvalidator&);
+    void addGuardedClass(std::string name) {
+        if (std::find(guarded_classes.begin(), guarded_classes.end(), name) == guarded_classes.end())
+            guarded_classes.push_back(std::move(name));
+    }
     void commit(CommitHook* hook, std::vector<void*> gc_references,
                 std::vector<std::pair<uint64_t, std::vector<Location>>> decref_infos,
                 llvm::ArrayRef<NextSlotJumpInfo> next_slot_jumps);
@@ -207,6 +250,8 @@ registerCompiledPatchpoint(uint8_t* start_addr, uint8_t* slowpath_start_addr, ui
                            std::vector<Location> ic_global_decref_locations = std::vector<Location>());
 
 ICInfo* getICInfo(void* rtn_addr);
+// Returns all the ICs of compiled code (ie the ones created by registerCompiledPatchpoint).
+std::vector<ICInfo*> getAllICInfos();
 
 void clearAllICs(); // mostly for refcount debugging
 }
@@ -283,6 +283,9 @@ void RewriterVar::addGuard(uint64_t val) {
         return;
     }
 
+    if (is_cls)
+        rewriter->addGuardedClass((BoxedClass*)val);
+
     RewriterVar* val_var = rewriter->loadConst(val);
     rewriter->addAction([=]() { rewriter->_addGuard(this, val_var); }, { this, val_var }, ActionType::GUARD);
 }
@@ -361,6 +364,14 @@ void RewriterVar::addGuardNotLt0() {
     }, { this }, ActionType::GUARD);
 }
 
+void RewriterVar::addClsGuard(BoxedClass* cls) {
+    // An attr guard at offsetof(Box, cls) isn't necessarily about a class (the var might be a PyGetSetDef, say), so
+    // the class gets recorded here rather than in addAttrGuard.
+    if (!attr_guards.count(std::make_tuple((int)offsetof(Box, cls), (uint64_t)cls, false)))
+        rewriter->addGuardedClass(cls);
+    addAttrGuard(offsetof(Box, cls), (uint64_t)cls);
+}
+
 void RewriterVar::addAttrGuard(int offset, uint64_t val, bool negate) {
     STAT_TIMER(t0, "us_timer_rewriter", 10);
 
@@ -416,6 +427,9 @@ void Rewriter::_addAttrGuard(RewriterVar* var, int offset, RewriterVar* val_cons
 RewriterVar* RewriterVar::getAttr(int offset, Location dest, assembler::MovType type) {
     STAT_TIMER(t0, "us_timer_rewriter", 10);
 
+    // A full-width load from this offset is a cls load (PyMemberDef::type, say, sits there too but is narrower).
+    bool loads_cls = offset == offsetof(Box, cls) && type == assembler::MovType::Q;
+
     // if no changing action happened we can reuse get attributes
     if (!rewriter->added_changing_action) {
         RewriterVar*& result = getattrs[std::make_pair(offset, (int)type)];
@@ -424,6 +438,7 @@ RewriterVar* RewriterVar::getAttr(int offset, Location dest, assembler::MovType
                 result->getInReg(dest, true /* allow_constant_in_reg */);
         } else {
             result = rewriter->createNewVar();
+            result->is_cls = loads_cls;
             rewriter->addAction([=]() { rewriter->_getAttr(result, this, offset, dest, type); }, { this },
                                 ActionType::NORMAL);
         }
@@ -431,6 +446,7 @@ RewriterVar* RewriterVar::getAttr(int offset, Location dest, assembler::MovType
     }
 
     RewriterVar* result = rewriter->createNewVar();
+    result->is_cls = loads_cls;
     rewriter->addAction([=]() { rewriter->_getAttr(result, this, offset, dest, type); }, { this }, ActionType::NORMAL);
     return result;
 }
@@ -533,6 +549,9 @@ void RewriterVar::xdecref() {
     rewriter->addAction([=]() { rewriter->_xdecref(this, { this }); }, { this }, ActionType::MUTATION);
 }
 
+// An object is immortal iff the upper 32 bits of its refcount are at least this (see _Py_IsImmortal).
+static const int32_t IMMORTAL_REFCNT_HIGH_HALF = (int32_t)((_Py_IMMORTAL_REFCNT >> 1) >> 32);
+
 void Rewriter::_incref(RewriterVar* var, int num_refs) {
     assert(num_refs > 0);
 
@@ -543,6 +562,9 @@ void Rewriter::_incref(RewriterVar* var, int num_refs) {
         return;
     }
 
+    if (var->isConstant() && _Py_IsPinned((Box*)var->constant_value))
+        return;
+
     assert(!var->nullable);
 // assembler->trap();
 // auto reg = var->getInReg();
@@ -565,6 +587,13 @@ void Rewriter::_incref(RewriterVar* var, int num_refs) {
     } else {
         auto reg = var->getInReg();
 
+#ifndef Py_REF_DEBUG
+        // Leave the refcount of immortal objects alone (see _Py_IsImmortal).  Looking at its upper half is enough.
+        assembler->cmpl(assembler::Indirect(reg, offsetof(Box, ob_refcnt) + 4),
+                        assembler::Immediate(IMMORTAL_REFCNT_HIGH_HALF));
+        assembler::ForwardJump jnl(*assembler, assembler::COND_NOT_LESS);
+#endif
+
         if (num_refs == 1)
             assembler->incq(assembler::Indirect(reg, offsetof(Box, ob_refcnt)));
         else
@@ -577,6 +606,13 @@ void Rewriter::_incref(RewriterVar* var, int num_refs) {
 
 void Rewriter::_decref(RewriterVar* var, llvm::ArrayRef<RewriterVar*> vars_to_bump) {
     assert(!var->nullable);
+
+    if (var->isConstant() && _Py_IsPinned((Box*)var->constant_value)) {
+        for (auto&& use : vars_to_bump) {
+            use->bumpUseLateIfNecessary();
+        }
+        return;
+    }
 // assembler->trap();
 
 // this->_call(NULL, true, false /* can't throw */, (void*)Helper::decref, { var }, {}, vars_to_bump);
@@ -596,8 +632,15 @@ void Rewriter::_decref(RewriterVar* var, llvm::ArrayRef<RewriterVar*> vars_to_bu
     auto reg = assembler::RDI;
     // auto reg = var->getInReg();
 
-    assembler->decq(assembler::Indirect(reg, offsetof(Box, ob_refcnt)));
     {
+#ifndef Py_REF_DEBUG
+        // Leave the refcount of immortal objects alone, like in _incref().
+        assembler->cmpl(assembler::Indirect(reg, offsetof(Box, ob_refcnt) + 4),
+                        assembler::Immediate(IMMORTAL_REFCNT_HIGH_HALF));
+        assembler::ForwardJump jnl(*assembler, assembler::COND_NOT_LESS);
+#endif
+
+        assembler->decq(assembler::Indirect(reg, offsetof(Box, ob_refcnt)));
         assembler::ForwardJump jnz(*assembler, assembler::COND_NOT_ZERO);
 #ifdef Py_TRACE_REFS
         _callOptimalEncoding(assembler::R11, (void*)_Py_Dealloc);
@@ -938,6 +981,10 @@ void Rewriter::addGCReference(void* obj) {
     gc_references.push_back(obj);
 }
 
+void Rewriter::addGuardedClass(BoxedClass* cls) {
+    rewrite->addGuardedClass(cls->tp_name);
+}
+
 RewriterVar* Rewriter::loadConst(int64_t val, Location dest) {
     STAT_TIMER(t0, "us_timer_rewriter", 10);
 
@@ -1931,6 +1978,116 @@ void Rewriter::_allocateAndCopyPlus1(RewriterVar* result, RewriterVar* first_ele
     assertConsistent();
 }
 
+RewriterVar* Rewriter::createTuple(llvm::ArrayRef<RewriterVar*> elts) {
+    STAT_TIMER(t0, "us_timer_rewriter", 10);
+
+    assert(elts.size() > 0 && elts.size() < PyTuple_MAXSAVESIZE);
+
+    RewriterVar* result = createNewVar();
+    llvm::ArrayRef<RewriterVar*> elts_array = regionAllocArgs(elts);
+    addAction([=]() { this->_createTuple(result, elts_array); }, elts_array, ActionType::MUTATION);
+    return result->setType(RefType::OWNED);
+}
+
+#ifndef Py_TRACE_REFS
+// _PyAlloc_Sample() for the inline tuple allocation, which needs the tuple back in RAX afterwards.
+static Box* sampleNewTuple(Box* tuple) noexcept {
+    _PyAlloc_Sample(tuple);
+    return tuple;
+}
+#endif
+
+void Rewriter::_createTuple(RewriterVar* result, llvm::ArrayRef<RewriterVar*> elts) {
+    if (LOG_IC_ASSEMBLY)
+        assembler->comment("_createTuple");
+
+    int nelts = elts.size();
+
+    // Both paths can end up calling out, so get everything out of the caller-save registers first.
+    // After this RAX, RSI, RDI and R11 are free to use as temporaries.
+    _setupCall(true, {});
+    if (failed)
+        return;
+
+#ifdef Py_TRACE_REFS
+    // Reviving a freelisted object has to re-add it to the list of all objects; don't try to do that inline.
+    assembler->mov(assembler::Immediate(nelts), assembler::RDI);
+    _callOptimalEncoding(assembler::R11, (void*)BoxedTuple::allocateUninitialized);
+    registerDecrefInfoHere();
+#else
+    // This is the freelist path of BoxedTuple::operator new.
+    const_loader.loadConstIntoReg((uint64_t)&BoxedTuple::free_list[nelts], assembler::RDI);
+    assembler->mov(assembler::Indirect(assembler::RDI, 0), assembler::RAX);
+    assembler->test(assembler::RAX, assembler::RAX);
+    {
+        assembler::ForwardJump jnz(*assembler, assembler::COND_NOT_ZERO);
+        assembler->mov(assembler::Immediate(nelts), assembler::RDI);
+        _callOptimalEncoding(assembler::R11, (void*)BoxedTuple::refillFreeList);
+        registerDecrefInfoHere();
+        const_loader.loadConstIntoReg((uint64_t)&BoxedTuple::free_list[nelts], assembler::RDI);
+    }
+
+    // Pop it; the link lives in elts[0], and ob_size and cls are still valid from the last use.
+    assembler->mov(assembler::Indirect(assembler::RAX, offsetof(BoxedTuple, elts)), assembler::RSI);
+    assembler->mov(assembler::RSI, assembler::Indirect(assembler::RDI, 0));
+    const_loader.loadConstIntoReg((uint64_t)&BoxedTuple::numfree[nelts], assembler::RDI);
+    assembler->decl(assembler::Indirect(assembler::RDI, 0));
+
+    // _Py_NewReference:
+    assembler->movq(assembler::Immediate(1), assembler::Indirect(assembler::RAX, offsetof(Box, ob_refcnt)));
+#ifdef Py_REF_DEBUG
+    assembler->incq(assembler::Immediate(&_Py_RefTotal));
+#endif
+
+    // _PyObject_GC_TRACK, with RDI pointing at the object's PyGC_Head and RSI at _PyGC_generation0:
+    assembler->lea(assembler::Indirect(assembler::RAX, -(int)sizeof(PyGC_Head)), assembler::RDI);
+    assembler->movq(assembler::Immediate((uint64_t)_PyGC_REFS_REACHABLE),
+                    assembler::Indirect(assembler::RDI, offsetof(PyGC_Head, gc.gc_refs)));
+    const_loader.loadConstIntoReg((uint64_t)_PyGC_generation0, assembler::RSI);
+    assembler->mov(assembler::RSI, assembler::Indirect(assembler::RDI, offsetof(PyGC_Head, gc.gc_next)));
+    assembler->mov(assembler::Indirect(assembler::RSI, offsetof(PyGC_Head, gc.gc_prev)), assembler::R11);
+    assembler->mov(assembler::R11, assembler::Indirect(assembler::RDI, offsetof(PyGC_Head, gc.gc_prev)));
+    assembler->mov(assembler::RDI, assembler::Indirect(assembler::R11, offsetof(PyGC_Head, gc.gc_next)));
+    assembler->mov(assembler::RDI, assembler::Indirect(assembler::RSI, offsetof(PyGC_Head, gc.gc_prev)));
+
+    // _PyAlloc_COUNT: take the tuple's size off the allocation profiler's countdown, and sample it if that goes
+    // negative.  The elements aren't filled in yet, but the sampler only looks at the class and the size.
+    const_loader.loadConstIntoReg((uint64_t)&_PyAlloc_BytesUntilSample, assembler::RDI);
+    assembler->add(assembler::Immediate(-tuple_cls->tp_basicsize), assembler::Indirect(assembler::RDI, 0));
+    {
+        assembler::ForwardJump jns(*assembler, assembler::COND_NOT_SIGN);
+        assembler->mov(assembler::RAX, assembler::RDI);
+        _callOptimalEncoding(assembler::R11, (void*)sampleNewTuple);
+    }
+#endif
+
+    result->initializeInReg(assembler::RAX);
+
+    for (int i = 0; i < nelts; i++) {
+        RewriterVar* elt = elts[i];
+        int offset = offsetof(BoxedTuple, elts) + sizeof(Box*) * i;
+
+        assembler::Register tuple_reg = result->getInReg();
+        bool is_immediate;
+        assembler::Immediate imm = elt->tryGetAsImmediate(&is_immediate);
+        if (is_immediate) {
+            assembler->movq(imm, assembler::Indirect(tuple_reg, offset));
+        } else {
+            assembler::Register elt_reg = elt->getInReg(Location::any(), false, /* otherThan */ tuple_reg);
+            assert(tuple_reg != elt_reg);
+            assembler->mov(elt_reg, assembler::Indirect(tuple_reg, offset));
+        }
+        _incref(elt);
+    }
+
+    for (RewriterVar* elt : elts) {
+        elt->bumpUse();
+    }
+
+    result->releaseIfNoUses();
+    assertConsistent();
+}
+
 void Rewriter::checkAndThrowCAPIException(RewriterVar* r, int64_t exc_val, assembler::MovType type) {
     STAT_TIMER(t0, "us_timer_rewriter", 10);
 
@@ -2354,9 +2511,9 @@ Rewriter* Rewriter::createRewriter(void* rtn_addr, int num_args, const char* deb
     // Horrible non-robust optimization: addresses below this address are probably in the binary (ex the interpreter),
     // so don't do the more-expensive hash table lookup to find it.
     if (rtn_addr > (void*)0x1000000) {
-        ic = getICInfo(rtn_addr);
+        ic = pyston::getICInfo(rtn_addr);
     } else {
-        ASSERT(!getICInfo(rtn_addr), "%p", rtn_addr);
+        ASSERT(!pyston::getICInfo(rtn_addr), "%p", rtn_addr);
     }
 
     log_ic_attempts(debug_name);
@@ -2366,6 +2523,8 @@ Rewriter* Rewriter::createRewriter(void* rtn_addr, int num_args, const char* deb
         return NULL;
     }
 
+    ic->noteSlowpathEntry();
+
     if (!ic->shouldAttempt()) {
         log_ic_attempts_skipped(debug_name);
 
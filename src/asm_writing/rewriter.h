@@ -149,6 +149,8 @@ public:
     void addGuardNotEq(uint64_t val);
     void addGuardNotLt0();
     void addAttrGuard(int offset, uint64_t val, bool negate = false);
+    // Guards on this object's class, and records the class for the IC's stats (see ICSlotRewrite::addGuardedClass).
+    void addClsGuard(BoxedClass* cls);
     RewriterVar* getAttr(int offset, Location loc = Location::any(), assembler::MovType type = assembler::MovType::Q);
     // getAttrFloat casts to double (maybe I should make that separate?)
     RewriterVar* getAttrFloat(int offset, Location loc = Location::any());
@@ -263,6 +265,8 @@ private:
     // Indicates if this variable is an arg, and if so, what location the arg is from.
     bool is_arg;
     bool is_constant;
+    // Whether this variable got loaded from offsetof(Box, cls), ie whether guards on its value are class guards.
+    bool is_cls = false;
 
     uint64_t constant_value;
     Location arg_loc;
@@ -560,6 +564,7 @@ protected:
     int _allocate(RewriterVar* result, int n);
     void _allocateAndCopy(RewriterVar* result, RewriterVar* array, int n);
     void _allocateAndCopyPlus1(RewriterVar* result, RewriterVar* first_elem, RewriterVar* rest, int n_rest);
+    void _createTuple(RewriterVar* result, llvm::ArrayRef<RewriterVar*> elts);
     void _checkAndThrowCAPIException(RewriterVar* r, int64_t exc_val, assembler::MovType size);
 
     // The public versions of these are in RewriterVar
@@ -632,6 +637,7 @@ public:
     Location getReturnDestination();
 
     TypeRecorder* getTypeRecorder();
+    ICInfo* getICInfo() { return rewrite->getICInfo(); }
 
     const char* debugName() { return rewrite->debugName(); }
 
@@ -640,6 +646,10 @@ public:
     // infer these from loadConst calls.
     void addGCReference(void* obj);
 
+    // Records that this rewrite guards on the given class (for __pyston__.getICs()).  Class guards that go through
+    // RewriterVar::addClsGuard or an addGuard on a loaded cls get recorded automatically.
+    void addGuardedClass(BoxedClass* cls);
+
 #ifndef NDEBUG
     void comment(const llvm::Twine& msg);
 #else
@@ -671,6 +681,10 @@ public:
     RewriterVar* allocate(int n);
     RewriterVar* allocateAndCopy(RewriterVar* array, int n);
     RewriterVar* allocateAndCopyPlus1(RewriterVar* first_elem, RewriterVar* rest, int n_rest);
+    // Creates a new tuple holding new references to elts (the result is owned).  The tuple comes off the
+    // per-length freelist inline; we only call out when that freelist is empty.
+    // Supports 1 <= elts.size() < PyTuple_MAXSAVESIZE.
+    RewriterVar* createTuple(llvm::ArrayRef<RewriterVar*> elts);
 
     // This emits `if (r == exc_val) throwCAPIException()`
     // type should be either MovType::Q if you want a 64bit comparison or MovType::L for a 32bit comparison.
@@ -1167,6 +1167,24 @@ extern "C" Py_ssize_t _Py_GetRefTotal(void) noexcept {
 #endif
     return total;
 }
+
+// The objects _Py_SetImmortal() was called on, see the comment in object.h.
+static std::vector<PyObject*> immortal_objects;
+
+extern "C" void _Py_SetImmortalDebug(PyObject* op) noexcept {
+    if (_Py_IsImmortal(op))
+        return;
+    op->ob_refcnt += _Py_IMMORTAL_REFCNT;
+    immortal_objects.push_back(op);
+}
+
+extern "C" void _Py_ReleaseImmortals(void) noexcept {
+    for (PyObject* op : immortal_objects) {
+        assert(_Py_IsImmortal(op));
+        op->ob_refcnt -= _Py_IMMORTAL_REFCNT;
+    }
+    immortal_objects.clear();
+}
 #endif /* Py_REF_DEBUG */
 
 #ifdef Py_REF_DEBUG
@@ -1263,6 +1281,7 @@ extern "C" void _Py_NewReference(PyObject* op) noexcept {
     op->ob_refcnt = 1;
     _Py_AddToAllObjects(op, 1);
     _Py_INC_TPALLOCS(op);
+    _PyAlloc_COUNT(op);
 }
 
 extern "C" void _Py_ForgetReference(register PyObject* op) noexcept {
@@ -18,6 +18,7 @@
 #include "capi/types.h"
 #include "runtime/classobj.h"
 #include "runtime/hiddenclass.h"
+#include "runtime/ics.h"
 #include "runtime/objmodel.h"
 #include "runtime/rewrite_args.h"
 
@@ -575,6 +576,37 @@ static PyObject* call_maybe(PyObject* o, const char* name, PyObject** nameobj, c
     return retval;
 }
 
+// Versions of call_method() and call_maybe() for the hot slots: every call site keeps its own CallattrCapiIC, which
+// guards on the receiver's class, so calling e.g. __hash__ on instances of the same Python class again skips both the
+// by-name lookup and building the argument tuple.  The arguments are always objects.
+// call_ic returns NULL without an exception set if the method doesn't exist.
+static PyObject* call_ic(CallattrCapiIC* ic, PyObject* self, const char* name, PyObject** nameobj, int nargs,
+                         PyObject* arg1 = NULL, PyObject* arg2 = NULL) noexcept {
+    if (*nameobj == NULL)
+        *nameobj = getStaticString(name);
+
+    CallattrFlags callattr_flags{.cls_only = true, .null_on_nonexistent = true, .argspec = ArgPassSpec(nargs) };
+    return ic->call(self, (BoxedString*)*nameobj, callattr_flags, arg1, arg2, NULL, NULL, NULL);
+}
+
+static PyObject* call_method_ic(CallattrCapiIC* ic, PyObject* self, const char* name, PyObject** nameobj, int nargs,
+                                PyObject* arg1 = NULL, PyObject* arg2 = NULL) noexcept {
+    PyObject* res = call_ic(ic, self, name, nameobj, nargs, arg1, arg2);
+    if (res == NULL && !PyErr_Occurred())
+        PyErr_SetObject(PyExc_AttributeError, *nameobj);
+    return res;
+}
+
+static PyObject* call_maybe_ic(CallattrCapiIC* ic, PyObject* self, const char* name, PyObject** nameobj, int nargs,
+                               PyObject* arg1 = NULL, PyObject* arg2 = NULL) noexcept {
+    PyObject* res = call_ic(ic, self, name, nameobj, nargs, arg1, arg2);
+    if (res == NULL && !PyErr_Occurred()) {
+        Py_INCREF(Py_NotImplemented);
+        return Py_NotImplemented;
+    }
+    return res;
+}
+
 static int half_compare(PyObject* self, PyObject* other) noexcept {
     PyObject* func, *args, *res;
     static PyObject* cmp_str;
@@ -660,23 +692,22 @@ static long slot_tp_hash(PyObject* self) noexcept {
 
     PyObject* func;
     static PyObject* hash_str, *eq_str, *cmp_str;
+    static CallattrCapiIC hash_ic;
     long h;
 
-    func = lookup_method(self, "__hash__", &hash_str);
+    // A __hash__ of None gets tp_hash set to PyObject_HashNotImplemented instead, so we only end up here if
+    // __hash__ is a real method or doesn't exist.
+    PyObject* res = call_ic(&hash_ic, self, "__hash__", &hash_str, 0);
 
-    if (func != NULL && func != Py_None) {
-        PyObject* res = PyEval_CallObject(func, NULL);
-        Py_DECREF(func);
-        if (res == NULL)
-            return -1;
+    if (res != NULL) {
         if (PyLong_Check(res))
             h = PyLong_Type.tp_hash(res);
         else
             h = PyInt_AsLong(res);
         Py_DECREF(res);
     } else {
-        Py_XDECREF(func); /* may be None */
-        PyErr_Clear();
+        if (PyErr_Occurred())
+            return -1;
         func = lookup_method(self, "__eq__", &eq_str);
         if (func == NULL) {
             PyErr_Clear();
@@ -715,9 +746,23 @@ static const char* name_op[] = {
 };
 
 static PyObject* half_richcompare(PyObject* self, PyObject* other, int op) noexcept {
-    PyObject* func, *args, *res;
     static PyObject* op_str[6];
+    static CallattrCapiIC op_ics[6];
+
+    if (op_str[op] == NULL)
+        op_str[op] = getStaticString(name_op[op]);
+
+    // Like CPython, a failed lookup (including an exception from binding a descriptor) means NotImplemented, so only
+    // take the IC path for plain functions, whose binding can't fail.
+    Box* method = typeLookup(self->cls, (BoxedString*)op_str[op]);
+    if (method == NULL) {
+        Py_INCREF(Py_NotImplemented);
+        return Py_NotImplemented;
+    }
+    if (method->cls == function_cls)
+        return call_maybe_ic(&op_ics[op], self, name_op[op], &op_str[op], 1, other);
 
+    PyObject* func, *args, *res;
     func = lookup_method(self, name_op[op], &op_str[op]);
     if (func == NULL) {
         PyErr_Clear();
@@ -796,7 +841,8 @@ PyObject* slot_tp_iter(PyObject* self) noexcept {
     STAT_TIMER(t0, "us_timer_slot_tpiternext", SLOT_AVOIDABILITY(self));
 
     static PyObject* next_str;
-    return call_method(self, "next", &next_str, "()");
+    static CallattrCapiIC next_ic;
+    return call_method_ic(&next_ic, self, "next", &next_str, 0);
 }
 
 static llvm_compat_bool slotTppHasnext(PyObject* self) {
@@ -1246,7 +1292,8 @@ PyObject* slot_sq_item(PyObject* self, Py_ssize_t i) noexcept {
     STAT_TIMER(t0, "us_timer_slot_sqlength", SLOT_AVOIDABILITY(self));
 
     static PyObject* len_str;
-    PyObject* res = call_method(self, "__len__", &len_str, "()");
+    static CallattrCapiIC len_ic;
+    PyObject* res = call_method_ic(&len_ic, self, "__len__", &len_str, 0);
     Py_ssize_t len;
 
     if (res == NULL)
@@ -1317,25 +1364,16 @@ static int slot_sq_ass_slice(PyObject* self, Py_ssize_t i, Py_ssize_t j, PyObjec
 /* Pyston change: static*/ int slot_sq_contains(PyObject* self, PyObject* value) noexcept {
     STAT_TIMER(t0, "us_timer_slot_sqcontains", SLOT_AVOIDABILITY(self));
 
-    PyObject* func, *res, *args;
+    PyObject* res;
     int result = -1;
 
     static PyObject* contains_str;
+    static CallattrCapiIC contains_ic;
 
-    func = lookup_maybe(self, "__contains__", &contains_str);
-    if (func != NULL) {
-        args = PyTuple_Pack(1, value);
-        if (args == NULL)
-            res = NULL;
-        else {
-            res = PyObject_Call(func, args, NULL);
-            Py_DECREF(args);
-        }
-        Py_DECREF(func);
-        if (res != NULL) {
-            result = PyObject_IsTrue(res);
-            Py_DECREF(res);
-        }
+    res = call_ic(&contains_ic, self, "__contains__", &contains_str, 1, value);
+    if (res != NULL) {
+        result = PyObject_IsTrue(res);
+        Py_DECREF(res);
     } else if (!PyErr_Occurred()) {
         /* Possible results: -1 and 1 */
         Py_FatalError("unimplemented");
@@ -1349,14 +1387,16 @@ static int slot_sq_ass_slice(PyObject* self, Py_ssize_t i, Py_ssize_t j, PyObjec
     static PyObject* FUNCNAME(PyObject* self) noexcept {                                                               \
         STAT_TIMER(t0, "us_timer_" #FUNCNAME, SLOT_AVOIDABILITY(self));                                                \
         static PyObject* cache_str;                                                                                    \
-        return call_method(self, OPSTR, &cache_str, "()");                                                             \
+        static CallattrCapiIC ic;                                                                                      \
+        return call_method_ic(&ic, self, OPSTR, &cache_str, 0);                                                        \
     }
 
 #define SLOT1(FUNCNAME, OPSTR, ARG1TYPE, ARGCODES)                                                                     \
     /* Pyston change: static */ PyObject* FUNCNAME(PyObject* self, ARG1TYPE arg1) noexcept {                           \
         STAT_TIMER(t0, "us_timer_" #FUNCNAME, SLOT_AVOIDABILITY(self));                                                \
         static PyObject* cache_str;                                                                                    \
-        return call_method(self, OPSTR, &cache_str, "(" ARGCODES ")", arg1);                                           \
+        static CallattrCapiIC ic;                                                                                      \
+        return call_method_ic(&ic, self, OPSTR, &cache_str, 1, arg1);                                                  \
     }
 
 /* Boolean helper for SLOT1BINFULL().
@@ -1394,25 +1434,26 @@ static int method_is_overloaded(PyObject* left, PyObject* right, const char* nam
 #define SLOT1BINFULL(FUNCNAME, TESTFUNC, SLOTNAME, OPSTR, ROPSTR)                                                      \
     static PyObject* FUNCNAME(PyObject* self, PyObject* other) noexcept {                                              \
         static PyObject* cache_str, *rcache_str;                                                                       \
+        static CallattrCapiIC ic, ric;                                                                                 \
         int do_other = Py_TYPE(self) != Py_TYPE(other) && Py_TYPE(other)->tp_as_number != NULL                         \
                        && Py_TYPE(other)->tp_as_number->SLOTNAME == TESTFUNC;                                          \
         if (Py_TYPE(self)->tp_as_number != NULL && Py_TYPE(self)->tp_as_number->SLOTNAME == TESTFUNC) {                \
             PyObject* r;                                                                                               \
             if (do_other && PyType_IsSubtype(Py_TYPE(other), Py_TYPE(self))                                            \
                 && method_is_overloaded(self, other, ROPSTR)) {                                                        \
-                r = call_maybe(other, ROPSTR, &rcache_str, "(O)", self);                                               \
+                r = call_maybe_ic(&ric, other, ROPSTR, &rcache_str, 1, self);                                          \
                 if (r != Py_NotImplemented)                                                                            \
                     return r;                                                                                          \
                 Py_DECREF(r);                                                                                          \
                 do_other = 0;                                                                                          \
             }                                                                                                          \
-            r = call_maybe(self, OPSTR, &cache_str, "(O)", other);                                                     \
+            r = call_maybe_ic(&ic, self, OPSTR, &cache_str, 1, other);                                                 \
             if (r != Py_NotImplemented || Py_TYPE(other) == Py_TYPE(self))                                             \
                 return r;                                                                                              \
             Py_DECREF(r);                                                                                              \
         }                                                                                                              \
         if (do_other) {                                                                                                \
-            return call_maybe(other, ROPSTR, &rcache_str, "(O)", self);                                                \
+            return call_maybe_ic(&ric, other, ROPSTR, &rcache_str, 1, self);                                           \
         }                                                                                                              \
         Py_INCREF(Py_NotImplemented);                                                                                  \
         return Py_NotImplemented;                                                                                      \
@@ -1435,11 +1476,12 @@ int slot_mp_ass_subscript(PyObject* self, PyObject* key, PyObject* value) noexce
 
     PyObject* res;
     static PyObject* delitem_str, *setitem_str;
+    static CallattrCapiIC delitem_ic, setitem_ic;
 
     if (value == NULL)
-        res = call_method(self, "__delitem__", &delitem_str, "(O)", key);
+        res = call_method_ic(&delitem_ic, self, "__delitem__", &delitem_str, 1, key);
     else
-        res = call_method(self, "__setitem__", &setitem_str, "(OO)", key, value);
+        res = call_method_ic(&setitem_ic, self, "__setitem__", &setitem_str, 2, key, value);
     if (res == NULL)
         return -1;
     Py_DECREF(res);
@@ -3535,6 +3577,7 @@ extern "C" int PyType_Ready(PyTypeObject* cls) noexcept {
 
     _Py_INC_REFTOTAL;
     classes.push_back(cls);
+    _Py_SetImmortal(cls);
 
     // unhandled fields:
     int ALLOWABLE_FLAGS = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_CHECKTYPES
@@ -97,6 +97,12 @@ public:
         return 0;
     }
 };
+// Calls a METH_FASTCALL function with the arguments starting at index `skip`; see capi.cpp.
+template <ExceptionStyle S>
+Box* callFastCFunction(PyMethodDef* ml, Box* self, RewriterVar* r_self, int skip, CallRewriteArgs* rewrite_args,
+                       ArgPassSpec argspec, Box* arg1, Box* arg2, Box* arg3, Box** args,
+                       const std::vector<BoxedString*>* keyword_names);
+
 static_assert(sizeof(BoxedCApiFunction) == sizeof(PyCFunctionObject), "");
 static_assert(offsetof(BoxedCApiFunction, method_def) == offsetof(PyCFunctionObject, m_ml), "");
 static_assert(offsetof(BoxedCApiFunction, passthrough) == offsetof(PyCFunctionObject, m_self), "");
@@ -28,6 +28,7 @@
 #include "codegen/irgen/irgenerator.h"
 #include "codegen/irgen/util.h"
 #include "codegen/osrentry.h"
+#include "codegen/profiling/deopt_trace.h"
 #include "core/bst.h"
 #include "core/cfg.h"
 #include "core/common.h"
@@ -56,7 +57,8 @@ namespace pyston {
 namespace {
 
 class ASTInterpreter;
-extern "C" Box* executeInnerAndSetupFrame(ASTInterpreter& interpreter, CFGBlock* start_block, BST_stmt* start_at);
+extern "C" Box* executeInnerAndSetupFrame(ASTInterpreter& interpreter, CFGBlock* start_block, BST_stmt* start_at,
+                                          bool is_deopt);
 
 /*
  * ASTInterpreters exist per function frame - there's no global interpreter object that executes
@@ -70,7 +72,8 @@ public:
 
     void initArguments(BoxedClosure* closure, BoxedGenerator* generator, Box* arg1, Box* arg2, Box* arg3, Box** args);
 
-    static Box* execute(ASTInterpreter& interpreter, CFGBlock* start_block = NULL, BST_stmt* start_at = NULL);
+    static Box* execute(ASTInterpreter& interpreter, CFGBlock* start_block = NULL, BST_stmt* start_at = NULL,
+                        bool is_deopt = false);
     static Box* executeInner(ASTInterpreter& interpreter, CFGBlock* start_block, BST_stmt* start_at);
 
 private:
@@ -80,7 +83,7 @@ private:
     Value doBinOp(BST_stmt* node, Value left, Value right, int op, BinExpType exp_type);
     void doStore(int vreg, STOLEN(Value) value);
     void doStoreArg(BST_Name* name, STOLEN(Value) value);
-    Box* doOSR(BST_Jump* node);
+    Box* doOSR(BST_Jump* node, FrameTier from_tier);
     Value getNone();
 
     Value getVReg(int vreg, bool kill = true);
@@ -114,6 +117,7 @@ private:
     Value visit_set(BST_Set* node);
     Value visit_stmt(BST_stmt* node);
     Value visit_tuple(BST_Tuple* node);
+    void visit_sunkTuple(BST_Tuple* node);
     Value visit_unaryop(BST_UnaryOp* node);
     Value visit_yield(BST_Yield* node);
     void visit_assert(BST_Assert* node);
@@ -159,6 +163,9 @@ private:
     std::unique_ptr<JitFragmentWriter> jit;
     bool should_jit;
 
+    // Elements of a tuple whose only use is the UnpackIntoArray right after it, see getSinkableUnpack().
+    llvm::SmallVector<Value, 4> sunk_tuple_elts;
+
 public:
     ~ASTInterpreter() { Py_XDECREF(this->created_closure); }
 
@@ -260,6 +267,8 @@ ASTInterpreter::ASTInterpreter(BoxedCode* code, Box** vregs, FrameInfo* deopt_fr
 
         // We are taking responsibility for calling deinit:
         deopt_frame_info->disableDeinit(&this->frame_info);
+
+        frame_info.tier = FrameTier::INTERPRETER;
     }
 
     frame_info.vregs = vregs;
@@ -355,11 +364,14 @@ Box* ASTInterpreter::execJITedBlock(CFGBlock* b) {
     try {
         UNAVOIDABLE_STAT_TIMER(t0, "us_timer_in_baseline_jitted_code");
         ++num_inside;
+        frame_info.tier = FrameTier::BASELINE_JIT;
         std::pair<CFGBlock*, Box*> rtn = b->entry_code(this, b, vregs);
+        frame_info.tier = FrameTier::INTERPRETER;
         --num_inside;
         next_block = rtn.first;
         return rtn.second;
     } catch (ExcInfo e) {
+        frame_info.tier = FrameTier::INTERPRETER;
         --num_inside;
         BST_stmt* stmt = getCurrentStatement();
         if (!stmt->is_invoke())
@@ -430,7 +442,7 @@ Box* ASTInterpreter::executeInner(ASTInterpreter& interpreter, CFGBlock* start_b
                     RELEASE_ASSERT(cur_stmt->type() == BST_TYPE::Jump, "");
                     // WARNING: do not put a try catch + rethrow block around this code here.
                     //          it will confuse our unwinder!
-                    rtn = interpreter.doOSR(cur_stmt);
+                    rtn = interpreter.doOSR(cur_stmt, FrameTier::BASELINE_JIT);
                     Py_CLEAR(v.o);
 
                     // rtn == NULL when the OSR failed and we have to continue with interpreting
@@ -462,11 +474,11 @@ Box* ASTInterpreter::executeInner(ASTInterpreter& interpreter, CFGBlock* start_b
     return v.o;
 }
 
-Box* ASTInterpreter::execute(ASTInterpreter& interpreter, CFGBlock* start_block, BST_stmt* start_at) {
+Box* ASTInterpreter::execute(ASTInterpreter& interpreter, CFGBlock* start_block, BST_stmt* start_at, bool is_deopt) {
     UNAVOIDABLE_STAT_TIMER(t0, "us_timer_in_interpreter");
     RECURSIVE_BLOCK(CXX, " in function call");
 
-    return executeInnerAndSetupFrame(interpreter, start_block, start_at);
+    return executeInnerAndSetupFrame(interpreter, start_block, start_at, is_deopt);
 }
 
 Value ASTInterpreter::doBinOp(BST_stmt* node, Value left, Value right, int op, BinExpType exp_type) {
@@ -546,6 +558,15 @@ Value ASTInterpreter::visit_unaryop(BST_UnaryOp* node) {
 }
 
 void ASTInterpreter::visit_unpackintoarray(BST_UnpackIntoArray* node) {
+    if (!sunk_tuple_elts.empty()) {
+        assert(sunk_tuple_elts.size() == node->num_elts);
+        for (int i = 0; i < node->num_elts; ++i) {
+            doStore(node->vreg_dst[i], sunk_tuple_elts[i]);
+        }
+        sunk_tuple_elts.clear();
+        return;
+    }
+
     Value value = getVReg(node->vreg_src);
     AUTO_DECREF(value.o);
 
@@ -642,7 +663,7 @@ Value ASTInterpreter::visit_jump(BST_Jump* node) {
     }
 
     if (backedge && edgecount >= OSR_THRESHOLD_BASELINE) {
-        Box* rtn = doOSR(node);
+        Box* rtn = doOSR(node, FrameTier::INTERPRETER);
         if (rtn)
             return Value(rtn, NULL);
     }
@@ -651,7 +672,7 @@ Value ASTInterpreter::visit_jump(BST_Jump* node) {
     return Value();
 }
 
-Box* ASTInterpreter::doOSR(BST_Jump* node) {
+Box* ASTInterpreter::doOSR(BST_Jump* node, FrameTier from_tier) {
     bool can_osr = ENABLE_OSR && !FORCE_INTERPRETER;
     if (!can_osr)
         return NULL;
@@ -753,6 +774,18 @@ Box* ASTInterpreter::doOSR(BST_Jump* node) {
     UNAVOIDABLE_STAT_TIMER(t0, "us_timer_in_jitted_code");
     CompiledFunction* partial_func = compilePartialFuncInternal(&exit);
 
+    DeoptEvent event;
+    event.kind = DeoptKind::OSR;
+    event.name = getCode()->name->s().str();
+    event.filename = getCode()->filename->s().str();
+    event.lineno = node->lineno;
+    event.node = BST_TYPE::stringify(node->type());
+    event.from_tier = from_tier;
+    event.to_tier = FrameTier::LLVM;
+    event.effort = (int)partial_func->effort;
+    event.version_invalidated = false;
+    logDeopt(std::move(event));
+
     // generator is only borrowed in order to not introduce cycles
     Box* r = partial_func->call_osr(generator, created_closure, &frame_info, arg_array.data());
 
@@ -795,13 +828,61 @@ Value ASTInterpreter::executeStmt(BST_stmt* node) {
     return v;
 }
 
+// `x += y` for a local x gets lowered to an AugBinOp whose result is stored back into x by the very next statement.
+// Returns x's vreg in that case, so that the add is allowed to reuse x's value (see strInplaceConcat).
+static int getInplaceAddTarget(BST_AugBinOp* node) {
+    if (node->op_type != AST_TYPE::Add || node->is_invoke() || node->is_terminator())
+        return VREG_UNDEFINED;
+
+    BST_stmt* next = (BST_stmt*)&((unsigned char*)node)[node->size_in_bytes()];
+    if (next->type() != BST_TYPE::StoreName)
+        return VREG_UNDEFINED;
+
+    BST_StoreName* store = (BST_StoreName*)next;
+    if (store->lookup_type != ScopeInfo::VarScopeType::FAST || store->vreg_value != node->vreg_dst)
+        return VREG_UNDEFINED;
+    return store->vreg;
+}
+
+// `a, b = b, a + b` gets lowered to a Tuple stored into a temporary which the very next statement unpacks again.
+// Returns that UnpackIntoArray if so: the tuple is never observable and we can pass its elements along directly
+// instead of allocating it (in the interpreter as well as in the bjit code we emit).
+static BST_UnpackIntoArray* getSinkableUnpack(BST_Tuple* node, const VRegInfo& vreg_info) {
+    if (node->num_elts == 0 || node->is_invoke() || node->is_terminator())
+        return NULL;
+
+    // The temporary must not be used anywhere else, since we never store the tuple into it.
+    if (node->vreg_dst == VREG_UNDEFINED || !vreg_info.isBlockLocalVReg(node->vreg_dst))
+        return NULL;
+
+    BST_stmt* next = (BST_stmt*)&((unsigned char*)node)[node->size_in_bytes()];
+    if (next->type() != BST_TYPE::UnpackIntoArray)
+        return NULL;
+
+    BST_UnpackIntoArray* unpack = (BST_UnpackIntoArray*)next;
+    if (unpack->vreg_src != node->vreg_dst || unpack->num_elts != node->num_elts)
+        return NULL;
+    return unpack;
+}
+
 Value ASTInterpreter::visit_augBinOp(BST_AugBinOp* node) {
     assert(node->op_type != AST_TYPE::Is && node->op_type != AST_TYPE::IsNot && "not tested yet");
 
     Value left = getVReg(node->vreg_left);
-    AUTO_DECREF(left.o);
     Value right = getVReg(node->vreg_right);
     AUTO_DECREF(right.o);
+
+    // Only strs can get appended to in place, everything else (and in the bjit, every local that wasn't a str when
+    // the block got traced) goes through the normal augbinop IC.
+    int target_vreg = left.o->cls == str_cls ? getInplaceAddTarget(node) : VREG_UNDEFINED;
+    // The bjit only keeps locals in the vregs array if they are live at the end of the block.
+    if (target_vreg != VREG_UNDEFINED && (!jit || getLiveness()->isLiveAtEnd(target_vreg, current_block))) {
+        frame_info.num_vregs = std::max(frame_info.num_vregs, target_vreg + 1);
+        return Value(ASTInterpreterJitInterface::inplaceAddHelper(this, left.o, right.o, target_vreg),
+                     jit ? jit->emitInplaceAdd(node, left, right, target_vreg) : NULL);
+    }
+
+    AUTO_DECREF(left.o);
     return doBinOp(node, left, right, node->op_type, BinExpType::AugBinOp);
 }
 
@@ -1035,6 +1116,11 @@ Value ASTInterpreter::visit_stmt(BST_stmt* node) {
                     v = visit_set((BST_Set*)node);
                     break;
                 case BST_TYPE::Tuple:
+                    if (getSinkableUnpack((BST_Tuple*)node, getVRegInfo())) {
+                        // The following UnpackIntoArray stores the elements, so there's nothing to store here.
+                        visit_sunkTuple((BST_Tuple*)node);
+                        return Value();
+                    }
                     v = visit_tuple((BST_Tuple*)node);
                     break;
                 case BST_TYPE::UnaryOp:
@@ -1808,6 +1894,14 @@ Value ASTInterpreter::visit_tuple(BST_Tuple* node) {
 
     return Value(rtn, jit ? jit->emitCreateTuple(items) : NULL);
 }
+
+void ASTInterpreter::visit_sunkTuple(BST_Tuple* node) {
+    assert(sunk_tuple_elts.empty());
+    // All elements have to be read before the unpack stores any of them, e.g. for `a, b = b, a`.
+    for (int i = 0; i < node->num_elts; ++i) {
+        sunk_tuple_elts.push_back(getVReg(node->elts[i]));
+    }
+}
 }
 
 
@@ -1916,6 +2010,17 @@ void ASTInterpreterJitInterface::setLocalClosureHelper(void* _interpreter, int v
     Py_XDECREF(prev_closure_elt);
 }
 
+Box* ASTInterpreterJitInterface::inplaceAddHelper(void* _interpreter, STOLEN(Box*) lhs, Box* rhs, int vreg) {
+    ASTInterpreter* interpreter = (ASTInterpreter*)_interpreter;
+
+    Box* r = strInplaceConcat(lhs, rhs, &interpreter->vregs[vreg]);
+    if (r)
+        return r;
+
+    AUTO_DECREF(lhs);
+    return augbinop(lhs, rhs, AST_TYPE::Add);
+}
+
 void ASTInterpreterJitInterface::uncacheExcInfoHelper(void* _interpreter) {
     ASTInterpreter* interpreter = (ASTInterpreter*)_interpreter;
     setFrameExcInfo(interpreter->getFrameInfo(), NULL, NULL, NULL);
@@ -1938,10 +2043,14 @@ Box* ASTInterpreterJitInterface::yieldHelper(void* _interpreter, STOLEN(Box*) va
 const void* interpreter_instr_addr = (void*)&executeInnerAndSetupFrame;
 
 // small wrapper around executeInner because we can not directly call the member function from asm.
-extern "C" Box* executeInnerFromASM(ASTInterpreter& interpreter, CFGBlock* start_block, BST_stmt* start_at) {
-    initFrame(interpreter.getFrameInfo());
+extern "C" Box* executeInnerFromASM(ASTInterpreter& interpreter, CFGBlock* start_block, BST_stmt* start_at,
+                                    bool is_deopt) {
+    if (is_deopt)
+        initDeoptedFrame(interpreter.getFrameInfo());
+    else
+        initFrame(interpreter.getFrameInfo());
     Box* rtn = ASTInterpreter::executeInner(interpreter, start_block, start_at);
-    deinitFrameMaybe(interpreter.getFrameInfo());
+    deinitFrameMaybe(interpreter.getFrameInfo(), rtn);
     return rtn;
 }
 
@@ -1954,8 +2063,19 @@ Box* astInterpretFunction(BoxedCode* code, Box* closure, Box* generator, Box* gl
     assert((!globals) == source_info->scoping.areGlobalsFromModule());
     bool can_reopt = ENABLE_REOPT && !FORCE_INTERPRETER;
 
-    if (unlikely(can_reopt
-                 && (FORCE_OPTIMIZE || !ENABLE_INTERPRETER || code->times_interpreted > REOPT_THRESHOLD_BASELINE))) {
+    // If all the versions we have are specialized on argument classes, we only get here because this call didn't
+    // match them.  The function is hot already, so compile the generic version right away instead of interpreting
+    // polymorphic callers until they hit the threshold again.
+    bool only_type_specialized_versions = !code->versions.empty();
+    for (CompiledFunction* cf : code->versions) {
+        if (cf->spec->accepts_all_inputs) {
+            only_type_specialized_versions = false;
+            break;
+        }
+    }
+
+    if (unlikely(can_reopt && (FORCE_OPTIMIZE || !ENABLE_INTERPRETER || only_type_specialized_versions
+                               || code->times_interpreted > REOPT_THRESHOLD_BASELINE))) {
         code->times_interpreted = 0;
 
         // EffortLevel new_effort = EffortLevel::MODERATE;
@@ -1963,20 +2083,35 @@ Box* astInterpretFunction(BoxedCode* code, Box* closure, Box* generator, Box* gl
         if (FORCE_OPTIMIZE)
             new_effort = EffortLevel::MAXIMAL;
 
+        // For the first version we specialize int and float arguments on their exact class, which lets irgen
+        // keep them unboxed from the function entry on.  Callers passing other classes will not match this
+        // version in pickVersion() and end up back here, where we then immediately compile a generic version.
+        bool create_type_specialized_version = code->versions.empty();
+
         std::vector<ConcreteCompilerType*> arg_types;
         for (int i = 0; i < code->param_names.totalParameters(); i++) {
             Box* arg = getArg(i, arg1, arg2, arg3, args);
 
             assert(arg || i == code->param_names.kwargsIndex()); // only builtin functions can pass NULL args
 
-            // TODO: reenable argument-type specialization
-            arg_types.push_back(UNKNOWN);
-            // arg_types.push_back(typeFromClass(arg->cls));
+            if (create_type_specialized_version && arg && (arg->cls == int_cls || arg->cls == float_cls))
+                arg_types.push_back(typeFromClass(arg->cls));
+            else
+                arg_types.push_back(UNKNOWN);
         }
         FunctionSpecialization* spec = new FunctionSpecialization(UNKNOWN, arg_types);
 
+        JitCompileReason reason;
+        if (code->killed_version_for_speculation_failure)
+            reason = JitCompileReason::SPECULATION_FAILURE;
+        else if (!create_type_specialized_version)
+            reason = JitCompileReason::RESPECIALIZE;
+        else
+            reason = JitCompileReason::TIERUP;
+        code->killed_version_for_speculation_failure = false;
+
         // this also pushes the new CompiledVersion to the back of the version list:
-        CompiledFunction* optimized = compileFunction(code, spec, new_effort, NULL);
+        CompiledFunction* optimized = compileFunction(code, spec, new_effort, NULL, reason);
 
         code->dependent_interp_callsites.invalidateAll();
 
@@ -2155,7 +2290,7 @@ extern "C" Box* astInterpretDeoptFromASM(BoxedCode* code, BST_stmt* enclosing_st
     // this make sure that we don't have unnecessary references around (e.g. could be a problem for PASSED_GENERATOR)
     Py_CLEAR(frame_state.locals);
 
-    Box* v = ASTInterpreter::execute(interpreter, start_block, starting_statement);
+    Box* v = ASTInterpreter::execute(interpreter, start_block, starting_statement, true /* is_deopt */);
     return v ? v : incref(Py_None);
 }
 
@@ -47,6 +47,7 @@ struct ASTInterpreterJitInterface {
     static void delNameHelper(void* _interpreter, InternedString name);
     static Box* derefHelper(void* interp, BST_LoadName* node);
     static Box* landingpadHelper(void* interp);
+    static Box* inplaceAddHelper(void* interp, STOLEN(Box*) lhs, Box* rhs, int vreg);
     static void pendingCallsCheckHelper();
     static void setExcInfoHelper(void* interp, STOLEN(Box*) type, STOLEN(Box*) value, STOLEN(Box*) traceback);
     static void setLocalClosureHelper(void* interp, int vreg, int closure_offset, Box* v);
@@ -20,6 +20,8 @@
 
 #include "codegen/irgen/hooks.h"
 #include "codegen/memmgr.h"
+#include "codegen/profiling/jit_events.h"
+#include "codegen/profiling/jitdump.h"
 #include "codegen/type_recording.h"
 #include "core/cfg.h"
 #include "runtime/generator.h"
@@ -231,6 +233,15 @@ RewriterVar* JitFragmentWriter::emitAugbinop(BST_stmt* node, RewriterVar* lhs, R
         .first->setType(RefType::OWNED);
 }
 
+RewriterVar* JitFragmentWriter::emitInplaceAdd(BST_stmt* node, STOLEN(RewriterVar*) lhs, RewriterVar* rhs, int vreg) {
+    // inplaceAddHelper never rewrites, so the patchpoint only needs to hold the call; it's there to record the result
+    // type for the llvm tier, like emitAugbinop does.
+    auto rtn = emitPPCall((void*)ASTInterpreterJitInterface::inplaceAddHelper, { getInterp(), lhs, rhs, imm(vreg) },
+                          64, true /* record type */, node);
+    lhs->refConsumed(rtn.second);
+    return rtn.first->setType(RefType::OWNED);
+}
+
 RewriterVar* JitFragmentWriter::emitApplySlice(RewriterVar* target, RewriterVar* lower, RewriterVar* upper) {
     if (!lower)
         lower = imm(0ul);
@@ -358,13 +369,9 @@ RewriterVar* JitFragmentWriter::emitCreateTuple(const llvm::ArrayRef<RewriterVar
     RewriterVar* r;
     if (num == 0) {
         r = imm(EmptyTuple)->setType(RefType::BORROWED);
-    } else if (num == 1)
-        r = call(false, (void*)BoxedTuple::create1, values[0])->setType(RefType::OWNED);
-    else if (num == 2)
-        r = call(false, (void*)BoxedTuple::create2, values[0], values[1])->setType(RefType::OWNED);
-    else if (num == 3)
-        r = call(false, (void*)BoxedTuple::create3, values[0], values[1], values[2])->setType(RefType::OWNED);
-    else {
+    } else if (num < PyTuple_MAXSAVESIZE) {
+        r = createTuple(values);
+    } else {
         r = emitCallWithAllocatedArgs((void*)createTupleHelper,
                                       { imm(num), allocArgs(values, RewriterVar::SetattrType::REF_USED) },
                                       values)->setType(RefType::OWNED);
@@ -716,6 +723,9 @@ void JitFragmentWriter::emitSetBlockLocal(int vreg, STOLEN(RewriterVar*) v) {
 }
 
 void JitFragmentWriter::emitSetCurrentInst(int offset) {
+    current_stmt_offset = offset;
+    if (PERF_JITDUMP)
+        addAction([=]() { jitdump_stmts.emplace_back(assembler->bytesWritten(), offset); }, {}, ActionType::NORMAL);
     getInterp()->setAttr(ASTInterpreterJitInterface::getCurrentInstOffset(), imm(offset),
                          RewriterVar::SetattrType::UNKNOWN, assembler::MovType::L);
 }
@@ -808,6 +818,9 @@ void JitFragmentWriter::abortCompilation() {
 std::pair<int, llvm::DenseSet<int>> JitFragmentWriter::finishCompilation() {
     RELEASE_ASSERT(!assembler->hasFailed(), "");
 
+    // The instructions get emitted while the block is being interpreted, but they only get assembled here.
+    Timer _t;
+
     commit();
     if (failed) {
         blocks_aborted.insert(block);
@@ -883,6 +896,10 @@ std::pair<int, llvm::DenseSet<int>> JitFragmentWriter::finishCompilation() {
             pp->associateNodeWithICInfo(pp_info.node, std::move(pp_info.type_recorder));
         else
             assert(!pp_info.type_recorder);
+        if (pp_info.stmt_offset != -1)
+            pp->setLocation(code, code->source->cfg->getStmtFromOffset(pp_info.stmt_offset)->lineno);
+        else
+            pp->setLocation(code, code->firstlineno);
         ic_infos.push_back(std::move(pp));
     }
 
@@ -898,9 +915,35 @@ std::pair<int, llvm::DenseSet<int>> JitFragmentWriter::finishCompilation() {
         ASSERT(assembler->curInstPointer() == (uint8_t*)exit_info.exit_start + exit_info.num_bytes,
                "Error! wrote more bytes out after the 'retq' that we thought was going to be the end of the assembly.  "
                "We will end up overwriting those instructions.");
+    if (PERF_JITDUMP) {
+        llvm::SmallVector<JitdumpLineEntry, 16> lines;
+        for (auto&& p : jitdump_stmts)
+            lines.push_back(JitdumpLineEntry{ (uint8_t*)block->code + p.first,
+                                              code->source->cfg->getStmtFromOffset(p.second)->lineno });
+        std::string name = ("bjit:" + code->name->s() + " (" + code->filename->s() + ":"
+                            + llvm::Twine(code->firstlineno) + ") block " + llvm::Twine(block->idx)).str();
+        jitdumpCodeLoad(name, block->code, assembler->bytesWritten(), code->filename->s(), lines);
+    }
+
     code_block.fragmentFinished(assembler->bytesWritten(), num_bytes_overlapping, next_fragment_start,
                                 std::move(ic_infos), *ic_info);
 
+    JitCompileEvent event;
+    event.tier = FrameTier::BASELINE_JIT;
+    event.effort = 0;
+    event.reason = JitCompileReason::TIERUP;
+    event.name = code->name->s().str();
+    event.filename = code->filename->s().str();
+    event.firstlineno = code->firstlineno;
+    event.block_idx = block->idx;
+    event.ir_size = 0;
+    for (BST_stmt* stmt : *block)
+        event.ir_size++;
+    event.compile_us = _t.end();
+    event.code_size = assembler->bytesWritten();
+    event.object_cache_hit = false;
+    logJitCompile(std::move(event));
+
     return std::make_pair(exit_info.num_bytes, std::move(known_non_null_vregs));
 }
 
@@ -964,6 +1007,7 @@ std::pair<RewriterVar*, RewriterAction*> JitFragmentWriter::emitPPCall(void* fun
     if (should_record_type)
         assert(ast_node);
 
+    pp_stmt_offsets.push_back(current_stmt_offset);
     RewriterAction* call_action
         = addAction([this, result, func_addr, ast_node, args_array, args_size, pp_size, num_additional]() {
             auto all_args = llvm::makeArrayRef(args_array, args_size + num_additional);
@@ -1202,8 +1246,10 @@ void JitFragmentWriter::_emitPPCall(RewriterVar* result, void* func_addr, llvm::
 
     StackInfo stack_info(pp_scratch_size, pp_scratch_location);
     auto&& decref_infos = getDecrefLocations();
+    assert(pp_infos.size() < pp_stmt_offsets.size());
     pp_infos.emplace_back(PPInfo{ func_addr, pp_start, pp_end, std::move(setup_info), stack_info, ast_node,
-                                  std::move(decref_infos), std::unique_ptr<TypeRecorder>() });
+                                  std::move(decref_infos), std::unique_ptr<TypeRecorder>(),
+                                  pp_stmt_offsets[pp_infos.size()] });
 
     assert(vars_by_location.count(assembler::RAX) == 0);
     result->initializeInReg(assembler::RAX);
@@ -252,10 +252,19 @@ private:
         BST_stmt* node;
         std::vector<Location> decref_infos;
         std::unique_ptr<TypeRecorder> type_recorder;
+        int stmt_offset;
     };
 
+    // The statement that was current when each patchpoint got requested, in order.  This is kept on the side
+    // because the emitting action doesn't have room to capture it.
+    int current_stmt_offset = -1;
+    llvm::SmallVector<int, 8> pp_stmt_offsets;
+
     llvm::SmallVector<PPInfo, 8> pp_infos;
 
+    // (offset from the fragment start, statement offset) of every statement, for the jitdump line table
+    llvm::SmallVector<std::pair<int, int>, 16> jitdump_stmts;
+
 public:
     JitFragmentWriter(BoxedCode* code, CFGBlock* block, std::unique_ptr<ICInfo> ic_info,
                       std::unique_ptr<ICSlotRewrite> rewrite, int code_offset, int num_bytes_overlapping,
@@ -267,6 +276,7 @@ public:
     RewriterVar* imm(const void* val);
 
     RewriterVar* emitAugbinop(BST_stmt* node, RewriterVar* lhs, RewriterVar* rhs, int op_type);
+    RewriterVar* emitInplaceAdd(BST_stmt* node, STOLEN(RewriterVar*) lhs, RewriterVar* rhs, int vreg);
     RewriterVar* emitApplySlice(RewriterVar* target, RewriterVar* lower, RewriterVar* upper);
     RewriterVar* emitBinop(BST_stmt* node, RewriterVar* lhs, RewriterVar* rhs, int op_type);
     RewriterVar* emitCallattr(BST_stmt* node, RewriterVar* obj, BoxedString* attr, CallattrFlags flags,
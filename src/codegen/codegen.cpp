@@ -109,6 +109,13 @@ void FunctionAddressRegistry::dumpPerfMap() {
     fclose(f);
 }
 
+int FunctionAddressRegistry::getFuncLengthAtAddress(void* addr) {
+    FuncMap::iterator it = functions.find(addr);
+    if (it == functions.end())
+        return 0;
+    return it->second.length;
+}
+
 llvm::Function* FunctionAddressRegistry::getLLVMFuncAtAddress(void* addr) {
     FuncMap::iterator it = functions.find(addr);
     if (it == functions.end()) {
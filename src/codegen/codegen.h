@@ -49,6 +49,8 @@ private:
 public:
     std::string getFuncNameAtAddress(void* addr, bool demangle, bool* out_success = NULL);
     llvm::Function* getLLVMFuncAtAddress(void* addr);
+    // Returns the size of the function that starts at addr, or 0 if we don't know it.
+    int getFuncLengthAtAddress(void* addr);
     void registerFunction(const std::string& name, void* addr, int length, llvm::Function* llvm_func);
     void deregisterFunction(void* addr) { functions.erase(addr); }
     void dumpPerfMap();
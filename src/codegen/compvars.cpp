@@ -21,12 +21,14 @@
 #include "llvm/IR/Module.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "asm_writing/icinfo.h"
 #include "codegen/codegen.h"
 #include "codegen/gcbuilder.h"
 #include "codegen/irgen.h"
 #include "codegen/irgen/util.h"
 #include "codegen/patchpoints.h"
 #include "core/bst.h"
+#include "core/cfg.h"
 #include "core/options.h"
 #include "core/types.h"
 #include "runtime/float.h"
@@ -711,9 +713,9 @@ _call(IREmitter& emitter, const OpInfo& info, llvm::Value* func, ExceptionStyle
     return new ConcreteCompilerVariable(rtn_type, rtn);
 }
 
-CompilerVariable* UnknownType::call(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var,
-                                    ArgPassSpec argspec, const std::vector<CompilerVariable*>& args,
-                                    const std::vector<BoxedString*>* keyword_names) {
+static ConcreteCompilerVariable* emitRuntimeCall(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var,
+                                                 ArgPassSpec argspec, const std::vector<CompilerVariable*>& args,
+                                                 const std::vector<BoxedString*>* keyword_names) {
     bool pass_keywords = (argspec.num_keywords != 0);
     int npassed_args = argspec.totalPassed();
 
@@ -743,6 +745,158 @@ CompilerVariable* UnknownType::call(IREmitter& emitter, const OpInfo& info, Conc
     return _call(emitter, info, func, exception_style, func_ptr, other_args, argspec, args, keyword_names, UNKNOWN);
 }
 
+// Callees bigger than this (in BST statements) aren't worth calling directly: the dispatch overhead we save is
+// a fixed cost.
+static const int DIRECT_CALL_MAX_STMTS = 60;
+
+// Returns the compiled version of `func` that a call site passing `nargs` positional arguments can call directly, or
+// NULL if there is none.
+//
+// We call the generated code without going through callChosenCF(), so this skips its recursion check; to keep that
+// from mattering we only accept callees that don't make any calls themselves.  Anything they call indirectly (through
+// a binop or a descriptor, say) goes through the runtime, which does the check.
+static CompiledFunction* getDirectCallTarget(BoxedFunction* func, int nargs, ExceptionStyle exception_style) {
+    if (func->closure || func->globals)
+        return NULL;
+
+    BoxedCode* code = func->code;
+    SourceInfo* source = code->source.get();
+    if (!source || !source->cfg || source->is_generator || !source->scoping.areGlobalsFromModule())
+        return NULL;
+
+    if (code->takes_varargs || code->takes_kwargs || code->num_args != nargs)
+        return NULL;
+
+    int nstmts = 0;
+    for (CFGBlock* block : source->cfg->blocks) {
+        for (BST_stmt* stmt : *block) {
+            switch (stmt->type()) {
+                case BST_TYPE::CallAttr:
+                case BST_TYPE::CallClsAttr:
+                case BST_TYPE::CallFunc:
+                case BST_TYPE::Exec:
+                    return NULL;
+                default:
+                    break;
+            }
+            if (++nstmts > DIRECT_CALL_MAX_STMTS)
+                return NULL;
+        }
+    }
+
+    for (CompiledFunction* cf : code->versions) {
+        if (cf->exception_style == exception_style && cf->spec->accepts_all_inputs && cf->spec->rtn_type == UNKNOWN)
+            return cf;
+    }
+    return NULL;
+}
+
+// If the bjit saw this call site always calling the same Python function, guard on its code object and call that
+// code's compiled version directly, skipping runtimeCall's dispatch and argument rearranging.  The function object
+// itself isn't passed to the compiled code (getDirectCallTarget only accepts functions without closures or custom
+// globals), so any function sharing the code is fine.  Any other callee goes through the normal runtimeCall path.
+static ConcreteCompilerVariable* tryDirectCall(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var,
+                                               ArgPassSpec argspec, const std::vector<CompilerVariable*>& args) {
+    if (!ENABLE_TYPE_FEEDBACK || !info.getBJitICInfo())
+        return NULL;
+
+    if (argspec.num_keywords || argspec.has_starargs || argspec.has_kwargs)
+        return NULL;
+
+    Box* callee = info.getBJitICInfo()->getMonomorphicCallee();
+    if (!callee || callee->cls != function_cls)
+        return NULL;
+
+    BoxedFunction* func = static_cast<BoxedFunction*>(callee);
+    ExceptionStyle exception_style = info.preferredExceptionStyle();
+    CompiledFunction* cf = getDirectCallTarget(func, argspec.num_args, exception_style);
+    if (!cf)
+        return NULL;
+
+    static StatCounter num_direct_calls("num_irgen_direct_python_calls");
+    num_direct_calls.log();
+
+    // The generated code embeds the code pointer, so it can't get freed (and its address reused) while the generated
+    // code can still run, ie as long as the caller's code object is alive.  The callee function itself isn't kept
+    // alive.
+    BoxedCode* callee_code = func->code;
+    emitter.currentFunction()->code_obj->keepAliveForJit(callee_code);
+
+    llvm::BasicBlock* bb_check_code = emitter.createBasicBlock("direct_call_check_code");
+    llvm::BasicBlock* bb_direct = emitter.createBasicBlock("direct_call");
+    llvm::BasicBlock* bb_generic = emitter.createBasicBlock("generic_call");
+    llvm::BasicBlock* bb_join = emitter.createBasicBlock("join_after_call");
+
+    llvm::Metadata* md_vals[]
+        = { llvm::MDString::get(g.context, "branch_weights"), llvm::ConstantAsMetadata::get(getConstantInt(1000)),
+            llvm::ConstantAsMetadata::get(getConstantInt(1)) };
+    llvm::MDNode* branch_weights = llvm::MDNode::get(g.context, llvm::ArrayRef<llvm::Metadata*>(md_vals));
+
+    // Only look at the code field once we know var is a function.
+    llvm::Value* is_func = var->makeClassCheck(emitter, function_cls);
+    emitter.getBuilder()->CreateCondBr(is_func, bb_check_code, bb_generic, branch_weights);
+
+    emitter.setCurrentBasicBlock(bb_check_code);
+    static_assert(offsetof(BoxedFunctionBase, code) % sizeof(void*) == 0, "");
+    llvm::Value* code_ptr = emitter.getBuilder()->CreateConstInBoundsGEP1_32(
+        emitter.getBuilder()->CreateBitCast(var->getValue(), g.llvm_value_type_ptr->getPointerTo()),
+        offsetof(BoxedFunctionBase, code) / sizeof(void*));
+    llvm::Value* cur_code = emitter.getBuilder()->CreateLoad(code_ptr);
+    emitter.setType(cur_code, RefType::BORROWED);
+    llvm::Value* is_code = emitter.getBuilder()->CreateICmpEQ(
+        cur_code, emitter.setType(embedRelocatablePtr(callee_code, g.llvm_value_type_ptr), RefType::BORROWED));
+    // This call site depends on cf the same way the callCLFunc ICs do: once cf gets invalidated (because it got
+    // reoptimized, or killed for failing its speculations), take the generic path, which picks the current version.
+    llvm::Value* version_field = embedRelocatablePtr(cf->dependent_callsites.versionAddr(), g.i64->getPointerTo());
+    llvm::Value* is_current = emitter.getBuilder()->CreateICmpEQ(
+        emitter.getBuilder()->CreateLoad(version_field), getConstantInt(cf->dependent_callsites.version(), g.i64));
+    llvm::Value* guard = emitter.getBuilder()->CreateAnd(is_code, is_current);
+    emitter.getBuilder()->CreateCondBr(guard, bb_direct, bb_generic, branch_weights);
+
+    emitter.setCurrentBasicBlock(bb_direct);
+    std::vector<llvm::Type*> arg_types;
+    for (int i = 0; i < argspec.num_args; i++) {
+        if (i == 3) {
+            arg_types.push_back(g.llvm_value_type_ptr->getPointerTo());
+            break;
+        }
+        arg_types.push_back(g.llvm_value_type_ptr);
+    }
+    llvm::FunctionType* ft = llvm::FunctionType::get(g.llvm_value_type_ptr, arg_types, false);
+    llvm::Value* linked_function = embedRelocatablePtr(cf->code, ft->getPointerTo());
+    std::vector<llvm::Value*> other_args;
+    ConcreteCompilerVariable* direct_rtn = _call(emitter, info, linked_function, cf->exception_style, cf->code,
+                                                 other_args, argspec, args, NULL, UNKNOWN);
+    llvm::BasicBlock* direct_end_bb = emitter.currentBasicBlock();
+    auto direct_terminator = emitter.getBuilder()->CreateBr(bb_join);
+
+    emitter.setCurrentBasicBlock(bb_generic);
+    ConcreteCompilerVariable* generic_rtn = emitRuntimeCall(emitter, info, var, argspec, args, NULL);
+    llvm::BasicBlock* generic_end_bb = emitter.currentBasicBlock();
+    auto generic_terminator = emitter.getBuilder()->CreateBr(bb_join);
+
+    emitter.setCurrentBasicBlock(bb_join);
+    auto phi = emitter.getBuilder()->CreatePHI(g.llvm_value_type_ptr, 2, "call");
+    phi->addIncoming(direct_rtn->getValue(), direct_end_bb);
+    phi->addIncoming(generic_rtn->getValue(), generic_end_bb);
+
+    emitter.refConsumed(direct_rtn->getValue(), direct_terminator);
+    emitter.refConsumed(generic_rtn->getValue(), generic_terminator);
+    emitter.setType(phi, RefType::OWNED);
+    if (exception_style == CAPI)
+        emitter.setNullable(phi, true);
+
+    return new ConcreteCompilerVariable(UNKNOWN, phi);
+}
+
+CompilerVariable* UnknownType::call(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var,
+                                    ArgPassSpec argspec, const std::vector<CompilerVariable*>& args,
+                                    const std::vector<BoxedString*>* keyword_names) {
+    if (ConcreteCompilerVariable* rtn = tryDirectCall(emitter, info, var, argspec, args))
+        return rtn;
+    return emitRuntimeCall(emitter, info, var, argspec, args, keyword_names);
+}
+
 CompilerVariable* UnknownType::callattr(IREmitter& emitter, const OpInfo& info, ConcreteCompilerVariable* var,
                                         BoxedString* attr, CallattrFlags flags,
                                         const std::vector<CompilerVariable*>& args,
@@ -1237,8 +1391,83 @@ public:
         return rtn;
     }
 
+    // Emits an add/sub/mul of two unboxed ints using the llvm.*.with.overflow intrinsics.  In the common case we just
+    // box the result; if the operation overflowed we call out to the runtime (ex add_i64_i64), which promotes
+    // to a long.  There's no deopt on that path, so the result is boxed and typed as UNKNOWN: the type analysis
+    // can't know statically whether it will be an int or a long.
+    //
+    // This only saves the boxing of the operands and the binop IC; the result still gets boxed, and chained
+    // arithmetic goes through the generic path after the first operation.  Keeping the result unboxed would need a
+    // compiler type for "int that may have become a long", which we don't have.
+    CompilerVariable* overflowCheckedBinexp(IREmitter& emitter, const OpInfo& info, VAR* var, VAR* rhs,
+                                            AST_TYPE::AST_TYPE op_type) {
+        llvm::Intrinsic::ID intrinsic_id;
+        llvm::Value* overflow_func;
+        switch (op_type) {
+            case AST_TYPE::Add:
+                intrinsic_id = llvm::Intrinsic::sadd_with_overflow;
+                overflow_func = g.funcs.add_i64_i64;
+                break;
+            case AST_TYPE::Sub:
+                intrinsic_id = llvm::Intrinsic::ssub_with_overflow;
+                overflow_func = g.funcs.sub_i64_i64;
+                break;
+            case AST_TYPE::Mult:
+                intrinsic_id = llvm::Intrinsic::smul_with_overflow;
+                overflow_func = g.funcs.mul_i64_i64;
+                break;
+            default:
+                RELEASE_ASSERT(0, "%s", getOpName(op_type)->c_str());
+        }
+
+        llvm::Value* lhs_val = var->getValue()->val;
+        llvm::Value* rhs_val = rhs->getValue()->val;
+        // If both sides are constants, llvm will fold all of this away.
+        llvm::Value* result_and_overflow
+            = emitter.getBuilder()->CreateCall(emitter.getIntrinsic(intrinsic_id, g.i64), { lhs_val, rhs_val });
+        llvm::Value* result = emitter.getBuilder()->CreateExtractValue(result_and_overflow, 0);
+        llvm::Value* overflowed = emitter.getBuilder()->CreateExtractValue(result_and_overflow, 1);
+
+        llvm::BasicBlock* bb_no_overflow = emitter.createBasicBlock("no_overflow");
+        llvm::BasicBlock* bb_overflow = emitter.createBasicBlock("overflow");
+        llvm::BasicBlock* bb_join = emitter.createBasicBlock("join_after_overflow_check");
+
+        llvm::Metadata* md_vals[]
+            = { llvm::MDString::get(g.context, "branch_weights"), llvm::ConstantAsMetadata::get(getConstantInt(1)),
+                llvm::ConstantAsMetadata::get(getConstantInt(1000)) };
+        llvm::MDNode* branch_weights = llvm::MDNode::get(g.context, llvm::ArrayRef<llvm::Metadata*>(md_vals));
+        emitter.getBuilder()->CreateCondBr(overflowed, bb_overflow, bb_no_overflow, branch_weights);
+
+        emitter.setCurrentBasicBlock(bb_no_overflow);
+        llvm::Value* boxed_int = emitter.getBuilder()->CreateCall(g.funcs.boxInt, result);
+        emitter.setType(boxed_int, RefType::OWNED);
+        llvm::BasicBlock* no_overflow_end_bb = emitter.currentBasicBlock();
+        auto no_overflow_terminator = emitter.getBuilder()->CreateBr(bb_join);
+
+        emitter.setCurrentBasicBlock(bb_overflow);
+        llvm::Value* boxed_long = emitter.createCall2(info.unw_info, overflow_func, lhs_val, rhs_val);
+        emitter.setType(boxed_long, RefType::OWNED);
+        llvm::BasicBlock* overflow_end_bb = emitter.currentBasicBlock();
+        auto overflow_terminator = emitter.getBuilder()->CreateBr(bb_join);
+
+        emitter.setCurrentBasicBlock(bb_join);
+        auto phi = emitter.getBuilder()->CreatePHI(g.llvm_value_type_ptr, 2, "int_binop");
+        phi->addIncoming(boxed_int, no_overflow_end_bb);
+        phi->addIncoming(boxed_long, overflow_end_bb);
+
+        emitter.refConsumed(boxed_int, no_overflow_terminator);
+        emitter.refConsumed(boxed_long, overflow_terminator);
+        emitter.setType(phi, RefType::OWNED);
+
+        return new ConcreteCompilerVariable(UNKNOWN, phi);
+    }
+
     CompilerVariable* binexp(IREmitter& emitter, const OpInfo& info, VAR* var, CompilerVariable* rhs,
                              AST_TYPE::AST_TYPE op_type, BinExpType exp_type) override {
+        if (rhs->getType() == INT && (exp_type == BinOp || exp_type == AugBinOp)
+            && (op_type == AST_TYPE::Add || op_type == AST_TYPE::Sub || op_type == AST_TYPE::Mult))
+            return overflowCheckedBinexp(emitter, info, var, static_cast<VAR*>(rhs), op_type);
+
         bool can_lower = (rhs->getType() == INT && exp_type == Compare);
         if (!can_lower) {
             // if the rhs is a float convert the lhs to a float and do the operation on it.
@@ -271,6 +271,7 @@ std::unique_ptr<llvm::MemoryBuffer> PystonObjectCache::getObject(const llvm::Mod
     static StatCounter jit_objectcache_misses("num_jit_objectcache_misses");
 
     module_identifier = M->getModuleIdentifier();
+    last_lookup_hit = false;
 
     RELEASE_ASSERT(!hash_before_codegen.empty(), "hash should have already got calculated");
 
@@ -310,6 +311,7 @@ std::unique_ptr<llvm::MemoryBuffer> PystonObjectCache::getObject(const llvm::Mod
     }
 
     jit_objectcache_hits.log();
+    last_lookup_hit = true;
     return mem_buff;
 }
 
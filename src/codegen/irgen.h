@@ -89,7 +89,8 @@ public:
     virtual llvm::Value* getScratch(int num_bytes) = 0;
     virtual void releaseScratch(llvm::Value*) = 0;
 
-    virtual llvm::Function* getIntrinsic(llvm::Intrinsic::ID) = 0;
+    // types should be specified for overloaded intrinsics (ex llvm.sadd.with.overflow.*)
+    virtual llvm::Function* getIntrinsic(llvm::Intrinsic::ID, llvm::ArrayRef<llvm::Type*> types = llvm::None) = 0;
 
     // Special value for capi_exc_value that says that the target function always sets a capi exception.
     static llvm::Value* ALWAYS_THROWS;
@@ -119,7 +120,7 @@ public:
     // virtual void checkAndPropagateCapiException(const UnwindInfo& unw_info, llvm::Value* returned_val,
     // llvm::Value* exc_val, bool double_check = false) = 0;
 
-    virtual llvm::Value* createDeopt(BST_stmt* current_stmt, llvm::Value* node_value) = 0;
+    virtual llvm::Value* createDeopt(BST_stmt* current_stmt, llvm::Value* node_value, BoxedClass* expected_cls) = 0;
 
     virtual BORROWED(Box*) getIntConstant(int64_t n) = 0;
     virtual BORROWED(Box*) getFloatConstant(double d) = 0;
@@ -189,6 +190,8 @@ private:
 public:
     PystonObjectCache();
 
+    bool last_lookup_hit = false; // whether the last getObject() found the object in the cache
+
 
 #if LLVMREV < 216002
     virtual void notifyObjectCompiled(const llvm::Module* M, const llvm::MemoryBuffer* Obj);
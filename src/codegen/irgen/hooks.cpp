@@ -40,6 +40,7 @@
 #include "codegen/osrentry.h"
 #include "codegen/parser.h"
 #include "codegen/patchpoints.h"
+#include "codegen/profiling/jit_events.h"
 #include "codegen/stackmaps.h"
 #include "codegen/unwinding.h"
 #include "core/bst.h"
@@ -60,13 +61,17 @@ LivenessAnalysis* SourceInfo::getLiveness(const CodeConstants& code_constants) {
     return liveness_info.get();
 }
 
-static void compileIR(CompiledFunction* cf, llvm::Function* func, EffortLevel effort) {
+static void compileIR(CompiledFunction* cf, llvm::Function* func, EffortLevel effort, JitCompileEvent& event) {
     assert(cf);
     assert(func);
 
     void* compiled = NULL;
     cf->code = NULL;
 
+    event.ir_size = 0;
+    for (llvm::BasicBlock& bb : *func)
+        event.ir_size += bb.size();
+
     {
         Timer _t("to jit the IR");
         llvm::Module* module = func->getParent();
@@ -83,6 +88,9 @@ static void compileIR(CompiledFunction* cf, llvm::Function* func, EffortLevel ef
         assert(compiled);
         ASSERT(compiled == cf->code, "cf->code should have gotten filled in");
 
+        event.object_cache_hit = g.object_cache && g.object_cache->last_lookup_hit;
+        event.code_size = g.func_addr_registry.getFuncLengthAtAddress(cf->code);
+
         long us = _t.end();
         static StatCounter us_jitting("us_compiling_jitting");
         us_jitting.log(us);
@@ -110,8 +118,8 @@ static void compileIR(CompiledFunction* cf, llvm::Function* func, EffortLevel ef
 // should only be called after checking to see if the other versions would work.
 // The codegen_lock needs to be held in W mode before calling this function:
 CompiledFunction* compileFunction(BoxedCode* code, FunctionSpecialization* spec, EffortLevel effort,
-                                  const OSREntryDescriptor* entry_descriptor, bool force_exception_style,
-                                  ExceptionStyle forced_exception_style) {
+                                  const OSREntryDescriptor* entry_descriptor, JitCompileReason reason,
+                                  bool force_exception_style, ExceptionStyle forced_exception_style) {
     UNAVOIDABLE_STAT_TIMER(t0, "us_timer_compileFunction");
     Timer _t("for compileFunction()", 1000);
 
@@ -183,11 +191,24 @@ CompiledFunction* compileFunction(BoxedCode* code, FunctionSpecialization* spec,
     llvm::Function* func = NULL;
     std::tie(cf, func)
         = doCompile(code, source, &code->param_names, entry_descriptor, effort, exception_style, spec, name->s());
-    compileIR(cf, func, effort);
+
+    JitCompileEvent event;
+    compileIR(cf, func, effort, event);
 
     code->addVersion(cf);
 
     long us = _t.end();
+
+    event.tier = FrameTier::LLVM;
+    event.effort = (int)effort;
+    event.reason = reason;
+    event.name = name->s().str();
+    event.filename = code->filename->s().str();
+    event.firstlineno = code->firstlineno;
+    event.block_idx = -1;
+    event.compile_us = us;
+    logJitCompile(std::move(event));
+
     static StatCounter us_compiling("us_compiling");
     us_compiling.log(us);
     if (VERBOSITY() >= 1 && us > 100000) {
@@ -518,7 +539,7 @@ void exec(Box* boxedCode, Box* globals, Box* locals, FutureFlags caller_future_f
 //
 // TODO we should have logic like this at the CLFunc level that detects that we keep
 // on creating functions with failing speculations, and then stop speculating.
-void CompiledFunction::speculationFailed() {
+bool CompiledFunction::speculationFailed() {
     this->times_speculation_failed++;
 
     if (this->times_speculation_failed == 4) {
@@ -526,6 +547,7 @@ void CompiledFunction::speculationFailed() {
 
         BoxedCode* code = this->code_obj;
         assert(code);
+        code->killed_version_for_speculation_failure = true;
         assert(this != code->always_use_version.get(exception_style));
 
         bool found = false;
@@ -553,7 +575,9 @@ void CompiledFunction::speculationFailed() {
             }
         }
         RELEASE_ASSERT(found, "");
+        return true;
     }
+    return false;
 }
 
 CompiledFunction::CompiledFunction(BoxedCode* code_obj, FunctionSpecialization* spec, void* code, EffortLevel effort,
@@ -599,7 +623,8 @@ static CompiledFunction* _doReopt(CompiledFunction* cf, EffortLevel new_effort)
             versions.erase(versions.begin() + i);
 
             // this pushes the new CompiledVersion to the back of the version list
-            CompiledFunction* new_cf = compileFunction(code, cf->spec, new_effort, NULL, true, cf->exception_style);
+            CompiledFunction* new_cf = compileFunction(code, cf->spec, new_effort, NULL, JitCompileReason::REOPT, true,
+                                                       cf->exception_style);
 
             cf->dependent_callsites.invalidateAll();
 
@@ -631,8 +656,8 @@ CompiledFunction* compilePartialFuncInternal(OSRExit* exit) {
     }
 
     EffortLevel new_effort = EffortLevel::MAXIMAL;
-    CompiledFunction* compiled
-        = compileFunction(code, NULL, new_effort, exit->entry, true, exit->entry->exception_style);
+    CompiledFunction* compiled = compileFunction(code, NULL, new_effort, exit->entry, JitCompileReason::OSR, true,
+                                                 exit->entry->exception_style);
     stat_osr_compiles.log();
     assert(std::find(code->osr_versions.begin(), code->osr_versions.end(), compiled) != code->osr_versions.end());
     return compiled;
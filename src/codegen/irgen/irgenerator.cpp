@@ -222,6 +222,11 @@ template <typename Builder> static llvm::Value* getCodeGep(Builder& builder, llv
     return builder.CreateConstInBoundsGEP2_32(v, 0, 9);
 }
 
+template <typename Builder> static llvm::Value* getTierGep(Builder& builder, llvm::Value* v) {
+    static_assert(offsetof(FrameInfo, tier) == 64 + 24, "");
+    return builder.CreateConstInBoundsGEP2_32(v, 0, 10);
+}
+
 void IRGenState::setupFrameInfoVar(llvm::Value* passed_closure, llvm::Value* passed_globals,
                                    llvm::Value* frame_info_arg) {
     /*
@@ -263,6 +268,7 @@ void IRGenState::setupFrameInfoVar(llvm::Value* passed_closure, llvm::Value* pas
 
         // The OSR case
         this->frame_info = frame_info_arg;
+        builder.CreateStore(getConstantInt((int)FrameTier::LLVM, g.i32), getTierGep(builder, frame_info_arg));
 
         // use vrags array from the interpreter
         vregs = builder.CreateLoad(getVRegsGep(builder, frame_info_arg));
@@ -336,6 +342,7 @@ void IRGenState::setupFrameInfoVar(llvm::Value* passed_closure, llvm::Value* pas
         builder.CreateStore(
             getRefcounts()->setType(embedRelocatablePtr(getCode(), g.llvm_code_type_ptr), RefType::BORROWED),
             getCodeGep(builder, al));
+        builder.CreateStore(getConstantInt((int)FrameTier::LLVM, g.i32), getTierGep(builder, al));
 
         this->frame_info = al;
         this->globals = passed_globals;
@@ -568,6 +575,8 @@ private:
         auto calling_convention = pp ? pp->getCallingConvention() : (llvm::CallingConv::ID)llvm::CallingConv::C;
         PatchpointInfo* info
             = PatchpointInfo::create(currentFunction(), std::move(pp), ic_stackmap_args.size(), func_addr);
+        if (unw_info.current_stmt)
+            info->setLineno(unw_info.current_stmt->lineno);
 
         int64_t pp_id = info->getId();
 
@@ -627,8 +636,9 @@ public:
 
     GCBuilder* getGC() override { return irstate->getGC(); }
 
-    llvm::Function* getIntrinsic(llvm::Intrinsic::ID intrinsic_id) override {
-        return llvm::Intrinsic::getDeclaration(g.cur_module, intrinsic_id);
+    llvm::Function* getIntrinsic(llvm::Intrinsic::ID intrinsic_id,
+                                 llvm::ArrayRef<llvm::Type*> types = llvm::None) override {
+        return llvm::Intrinsic::getDeclaration(g.cur_module, intrinsic_id, types);
     }
 
     llvm::Value* getScratch(int num_bytes) override { return irstate->getScratchSpace(num_bytes); }
@@ -716,8 +726,10 @@ public:
         return rtn.getInstruction();
     }
 
-    llvm::Value* createDeopt(BST_stmt* current_stmt, llvm::Value* node_value) override {
-        llvm::Instruction* v = createIC(createDeoptIC(), (void*)pyston::deopt, { node_value },
+    llvm::Value* createDeopt(BST_stmt* current_stmt, llvm::Value* node_value, BoxedClass* expected_cls) override {
+        llvm::Value* expected_cls_value
+            = setType(embedRelocatablePtr(expected_cls, g.llvm_class_type_ptr), RefType::BORROWED);
+        llvm::Instruction* v = createIC(createDeoptIC(), (void*)pyston::deopt, { node_value, expected_cls_value },
                                         UnwindInfo(irstate->getCode(), current_stmt, NULL, /* is_after_deopt*/ true));
         llvm::Value* rtn = createAfter<llvm::IntToPtrInst>(v, v, g.llvm_value_type_ptr, "");
         setType(rtn, RefType::OWNED);
@@ -827,7 +839,8 @@ private:
 
     OpInfo getEmptyOpInfo(const UnwindInfo& unw_info) { return OpInfo(irstate->getEffortLevel(), unw_info, NULL); }
 
-    void createExprTypeGuard(llvm::Value* check_val, llvm::Value* node_value, BST_stmt* current_statement) {
+    void createExprTypeGuard(llvm::Value* check_val, llvm::Value* node_value, BoxedClass* expected_cls,
+                             BST_stmt* current_statement) {
         assert(check_val->getType() == g.i1);
 
         llvm::Metadata* md_vals[]
@@ -848,7 +861,7 @@ private:
 
         curblock = deopt_bb;
         emitter.getBuilder()->SetInsertPoint(curblock);
-        llvm::Value* v = emitter.createDeopt(current_statement, node_value);
+        llvm::Value* v = emitter.createDeopt(current_statement, node_value, expected_cls);
         llvm::Instruction* ret_inst = emitter.getBuilder()->CreateRet(v);
         irstate->getRefcounts()->refConsumed(v, ret_inst);
 
@@ -1639,7 +1652,7 @@ private:
 
             llvm::Value* guard_check = old_rtn->makeClassCheck(emitter, speculated_class);
             assert(guard_check->getType() == g.i1);
-            createExprTypeGuard(guard_check, old_rtn->getValue(), unw_info.current_stmt);
+            createExprTypeGuard(guard_check, old_rtn->getValue(), speculated_class, unw_info.current_stmt);
 
             rtn = unboxVar(speculated_type, old_rtn->getValue());
         }
@@ -2132,8 +2145,13 @@ private:
 
         emitter.emitSetCurrentStmt(node);
 
-        if (!irstate->getCurFunction()->entry_descriptor)
-            emitter.getBuilder()->CreateCall(g.funcs.deinitFrame, irstate->getFrameInfoVar());
+        if (!irstate->getCurFunction()->entry_descriptor) {
+            // The return value is only for profile and trace functions, which can't take unboxed values.
+            llvm::Value* traced_rtn = rtn->getValue()->getType() == g.llvm_value_type_ptr
+                                          ? rtn->getValue()
+                                          : getNullPtr(g.llvm_value_type_ptr);
+            emitter.getBuilder()->CreateCall2(g.funcs.deinitFrame, irstate->getFrameInfoVar(), traced_rtn);
+        }
 
         assert(rtn->getValue());
         auto ret_inst = emitter.getBuilder()->CreateRet(rtn->getValue());
@@ -3003,7 +3021,8 @@ public:
                     emitter.getBuilder()->CreateUnreachable();
                 } else {
                     if (!irstate->getCurFunction()->entry_descriptor && !is_after_deopt)
-                        emitter.getBuilder()->CreateCall(g.funcs.deinitFrame, irstate->getFrameInfoVar());
+                        emitter.getBuilder()->CreateCall2(g.funcs.deinitFrame, irstate->getFrameInfoVar(),
+                                                          getNullPtr(g.llvm_value_type_ptr));
                     emitter.getBuilder()->CreateRet(getNullPtr(g.llvm_value_type_ptr));
                 }
             } else {
@@ -3090,7 +3109,8 @@ public:
             irstate->getRefcounts()->refConsumed(exc_value, call_inst);
             irstate->getRefcounts()->refConsumed(exc_traceback, call_inst);
             if (!irstate->getCurFunction()->entry_descriptor && !unw_info.is_after_deopt) {
-                emitter.getBuilder()->CreateCall(g.funcs.deinitFrame, irstate->getFrameInfoVar());
+                emitter.getBuilder()->CreateCall2(g.funcs.deinitFrame, irstate->getFrameInfoVar(),
+                                                  getNullPtr(g.llvm_value_type_ptr));
             }
             emitter.getBuilder()->CreateRet(getNullPtr(g.llvm_value_type_ptr));
         } else {
@@ -204,6 +204,12 @@ llvm::Instruction* findInsertionPoint(llvm::BasicBlock* BB, llvm::BasicBlock* fr
 #define REFCOUNT_IDX 0
 #endif
 
+// Constants that point to immortal objects (see _Py_IsImmortal) don't need any refcount operations.
+static bool isImmortalConstant(llvm::Value* v) {
+    const void* addr = getEmbeddedPtr(v);
+    return addr && _Py_IsPinned((Box*)addr);
+}
+
 void addIncrefs(llvm::Value* v, bool nullable, int num_refs, llvm::Instruction* incref_pt) {
     if (num_refs > 1) {
         // Not bad but I don't think this should happen:
@@ -216,6 +222,9 @@ void addIncrefs(llvm::Value* v, bool nullable, int num_refs, llvm::Instruction*
         return;
     }
 
+    if (isImmortalConstant(v))
+        return;
+
     assert(num_refs > 0);
 
     llvm::BasicBlock* cur_block;
@@ -245,6 +254,29 @@ void addIncrefs(llvm::Value* v, bool nullable, int num_refs, llvm::Instruction*
         builder.SetInsertPoint(incref_block);
     }
 
+#ifndef Py_REF_DEBUG
+    // Leave the refcount of immortal objects alone (see _Py_IsImmortal):
+    if (!continue_block) {
+        cur_block = incref_pt->getParent();
+        continue_block = cur_block->splitBasicBlock(incref_pt);
+
+        assert(llvm::isa<llvm::BranchInst>(cur_block->getTerminator()));
+        cur_block->getTerminator()->eraseFromParent();
+        builder.SetInsertPoint(cur_block);
+    }
+#endif
+
+    auto refcount_ptr = builder.CreateConstInBoundsGEP2_32(v, 0, REFCOUNT_IDX);
+    auto refcount = builder.CreateLoad(refcount_ptr);
+
+#ifndef Py_REF_DEBUG
+    llvm::BasicBlock* mortal_block
+        = llvm::BasicBlock::Create(g.context, "incref_mortal", incref_pt->getParent()->getParent(), continue_block);
+    auto is_immortal = builder.CreateICmpSGE(refcount, getConstantInt(_Py_IMMORTAL_REFCNT >> 1, g.i64));
+    builder.CreateCondBr(is_immortal, continue_block, mortal_block);
+    builder.SetInsertPoint(mortal_block);
+#endif
+
 #ifdef Py_REF_DEBUG
     auto reftotal_gv = g.cur_module->getOrInsertGlobal("_Py_RefTotal", g.i64);
     auto reftotal = builder.CreateLoad(reftotal_gv);
@@ -252,12 +284,10 @@ void addIncrefs(llvm::Value* v, bool nullable, int num_refs, llvm::Instruction*
     builder.CreateStore(new_reftotal, reftotal_gv);
 #endif
 
-    auto refcount_ptr = builder.CreateConstInBoundsGEP2_32(v, 0, REFCOUNT_IDX);
-    auto refcount = builder.CreateLoad(refcount_ptr);
     auto new_refcount = builder.CreateAdd(refcount, getConstantInt(num_refs, g.i64));
     builder.CreateStore(new_refcount, refcount_ptr);
 
-    if (nullable)
+    if (continue_block)
         builder.CreateBr(continue_block);
 }
 
@@ -275,6 +305,9 @@ void addDecrefs(llvm::Value* v, bool nullable, int num_refs, llvm::Instruction*
         return;
     }
 
+    if (isImmortalConstant(v))
+        return;
+
     assert(num_refs > 0);
     llvm::IRBuilder<true> builder(decref_pt);
 
@@ -1212,34 +1245,90 @@ void RefcountTracker::addRefcounts(IRGenState* irstate) {
     for (int idx = 0; idx < num_bb; idx++) {
         auto&& state = states[idx];
         for (auto& op : state.increfs) {
-            auto insertion_pt = op.insertion_inst;
-            if (!insertion_pt)
-                insertion_pt = findInsertionPoint(op.insertion_bb, op.insertion_from_bb, insertion_pts);
+            if (!op.insertion_inst)
+                op.insertion_inst = findInsertionPoint(op.insertion_bb, op.insertion_from_bb, insertion_pts);
         }
         for (auto& op : state.decrefs) {
-            auto insertion_pt = op.insertion_inst;
-            if (!insertion_pt)
-                insertion_pt = findInsertionPoint(op.insertion_bb, op.insertion_from_bb, insertion_pts);
+            if (!op.insertion_inst)
+                op.insertion_inst = findInsertionPoint(op.insertion_bb, op.insertion_from_bb, insertion_pts);
+        }
+    }
+
+    // The analysis above works per-block, so it will happily incref a value on the way into a block and then decref
+    // it again a few instructions later (e.g. when the successor only needed the ref to keep it alive through some
+    // loads).  Cancel those pairs out, as long as nothing in between could look at or drop a reference: no calls,
+    // and no decrefs of other values.  The scan follows unconditional branches into blocks that can only be reached
+    // from the current one, so a pair that got split across a straight-line chain of blocks (ex an edge's breaker
+    // block and the block after it) cancels out too.
+    static StatCounter num_refops_elided("num_irgen_refcount_ops_elided");
+    {
+        llvm::DenseMap<llvm::Instruction*, llvm::SmallVector<RefOp*, 2>> decrefs_at;
+        for (auto&& state : states) {
+            for (auto& op : state.decrefs)
+                decrefs_at[op.insertion_inst].push_back(&op);
+        }
+
+        auto find_decref = [&](llvm::Instruction* I, llvm::Value* v, bool other_values) -> RefOp* {
+            auto it = decrefs_at.find(I);
+            if (it == decrefs_at.end())
+                return NULL;
+            for (RefOp* op : it->second) {
+                if (op->num_refs && (op->operand == v) != other_values)
+                    return op;
+            }
+            return NULL;
+        };
+
+        // (A chain of single-predecessor blocks can only be a cycle if it is unreachable; stop when we get back to
+        // where we started.)
+        auto next_inst = [](llvm::Instruction* I, llvm::BasicBlock* start) -> llvm::Instruction* {
+            if (llvm::Instruction* next = I->getNextNode())
+                return next;
+            auto br = dyn_cast<BranchInst>(I);
+            if (!br || br->isConditional())
+                return NULL;
+            llvm::BasicBlock* succ = br->getSuccessor(0);
+            if (succ == start || succ->getSinglePredecessor() != I->getParent())
+                return NULL;
+            return &succ->front();
+        };
+
+        for (auto&& state : states) {
+            for (auto& op : state.increfs) {
+                llvm::BasicBlock* start_bb = op.insertion_inst->getParent();
+                while (op.num_refs) {
+                    RefOp* match = NULL;
+                    for (llvm::Instruction* I = op.insertion_inst; I; I = next_inst(I, start_bb)) {
+                        if (find_decref(I, op.operand, true))
+                            break;
+                        if ((match = find_decref(I, op.operand, false)))
+                            break;
+                        if ((isa<CallInst>(I) && !isa<DbgInfoIntrinsic>(I)) || isa<InvokeInst>(I))
+                            break;
+                    }
+                    if (!match)
+                        break;
+
+                    op.num_refs--;
+                    match->num_refs--;
+                    num_refops_elided.log(2);
+                }
+            }
         }
     }
 
-    // Then use the insertion points (it's the same code but this time it will hit the cache).
-    // This may change the CFG by adding decref's
+    // Then insert the refcount operations.  This may change the CFG by adding decref's
     for (int idx = 0; idx < num_bb; idx++) {
         auto&& state = states[idx];
         for (auto& op : state.increfs) {
             assert(rt->vars.count(op.operand));
-            auto insertion_pt = op.insertion_inst;
-            if (!insertion_pt)
-                insertion_pt = findInsertionPoint(op.insertion_bb, op.insertion_from_bb, insertion_pts);
-            addIncrefs(op.operand, op.nullable, op.num_refs, insertion_pt);
+            if (op.num_refs)
+                addIncrefs(op.operand, op.nullable, op.num_refs, op.insertion_inst);
         }
         for (auto& op : state.decrefs) {
             assert(rt->vars.count(op.operand));
-            auto insertion_pt = op.insertion_inst;
-            if (!insertion_pt)
-                insertion_pt = findInsertionPoint(op.insertion_bb, op.insertion_from_bb, insertion_pts);
-            addDecrefs(op.operand, op.nullable, op.num_refs, insertion_pt);
+            if (op.num_refs)
+                addDecrefs(op.operand, op.nullable, op.num_refs, op.insertion_inst);
         }
 
         for (auto&& fixup : state.cxx_fixups) {
@@ -52,6 +52,22 @@ const void* getValueOfRelocatableSym(llvm::StringRef str) {
     return NULL;
 }
 
+const void* getEmbeddedPtr(llvm::Value* v) {
+    if (llvm::GlobalVariable* gv = llvm::dyn_cast<llvm::GlobalVariable>(v))
+        return getValueOfRelocatableSym(gv->getName());
+
+    llvm::ConstantExpr* ce = llvm::dyn_cast<llvm::ConstantExpr>(v);
+    if (!ce || !ce->isCast())
+        return NULL;
+
+    if (ce->getOpcode() == llvm::Instruction::IntToPtr) {
+        if (llvm::ConstantInt* ci = llvm::dyn_cast<llvm::ConstantInt>(ce->getOperand(0)))
+            return reinterpret_cast<const void*>(ci->getZExtValue());
+        return NULL;
+    }
+    return getEmbeddedPtr(ce->getOperand(0));
+}
+
 llvm::Constant* embedRelocatablePtr(const void* addr, llvm::Type* type, llvm::StringRef shared_name) {
     assert(addr);
 
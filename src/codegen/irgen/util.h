@@ -44,6 +44,8 @@ llvm::Constant* getNullPtr(llvm::Type* t);
 void clearRelocatableSymsMap();
 void setPointersInCodeStorage(std::vector<const void*>* v);
 const void* getValueOfRelocatableSym(llvm::StringRef str);
+// Returns the address that embedRelocatablePtr/embedConstantPtr embedded into v, or NULL if v isn't such a constant.
+const void* getEmbeddedPtr(llvm::Value* v);
 
 void visitRelocatableSymsMap(gc::GCVisitor* visitor);
 
@@ -151,18 +151,25 @@ static LiveOutSet extractLiveOuts(StackMap::Record* r, llvm::CallingConv::ID cc)
 
 #if !defined(Py_REF_DEBUG) && !defined(Py_TRACE_REFS)
 
-static char decref_code[] = "\x48\xff\x0f"     // decq (%rdi)
-                            "\x75\x07"         // jne +7
-                            "\x48\x8b\x47\x08" // mov 0x8(%rdi),%rax
-                            "\xff\x50\x30"     // callq *0x30(%rax)
+// Immortal objects (see _Py_IsImmortal) are skipped by looking at the upper half of the refcount:
+static_assert((_Py_IMMORTAL_REFCNT >> 1) == 0x2000000000000000L, "update the cmpl below");
+
+static char decref_code[] = "\x81\x7f\x04\x00\x00\x00\x20" // cmpl $0x20000000,0x4(%rdi)
+                            "\x7d\x0c"                     // jge +12
+                            "\x48\xff\x0f"                 // decq (%rdi)
+                            "\x75\x07"                     // jne +7
+                            "\x48\x8b\x47\x08"             // mov 0x8(%rdi),%rax
+                            "\xff\x50\x30"                 // callq *0x30(%rax)
     ;
 
-static char xdecref_code[] = "\x48\x85\xff"     // test %rdi,%rdi
-                             "\x74\x0c"         // je +12
-                             "\x48\xff\x0f"     // decq (%rdi)
-                             "\x75\x07"         // jne +7
-                             "\x48\x8b\x47\x08" // mov 0x8(%rdi),%rax
-                             "\xff\x50\x30"     // callq *0x30(%rax)
+static char xdecref_code[] = "\x48\x85\xff"                 // test %rdi,%rdi
+                             "\x74\x15"                     // je +21
+                             "\x81\x7f\x04\x00\x00\x00\x20" // cmpl $0x20000000,0x4(%rdi)
+                             "\x7d\x0c"                     // jge +12
+                             "\x48\xff\x0f"                 // decq (%rdi)
+                             "\x75\x07"                     // jne +7
+                             "\x48\x8b\x47\x08"             // mov 0x8(%rdi),%rax
+                             "\xff\x50\x30"                 // callq *0x30(%rax)
     ;
 
 #else
@@ -339,6 +346,7 @@ void processStackmap(CompiledFunction* cf, StackMap* stackmap) {
             std::move(initialization_info.live_outs));
 
         assert(cf);
+        icinfo->setLocation(cf->code_obj, pp->getLineno());
         cf->ics.push_back(std::move(icinfo));
     }
 
@@ -114,6 +114,7 @@ private:
     int num_frame_stackmap_args;
     bool is_frame_info_stackmap;
     unsigned int id;
+    int lineno; // of the statement this patchpoint belongs to, or -1
 
     FrameInfoDesc frame_info_desc;
 
@@ -123,7 +124,8 @@ private:
           num_ic_stackmap_args(num_ic_stackmap_args),
           num_frame_stackmap_args(-1),
           is_frame_info_stackmap(false),
-          id(0) {}
+          id(0),
+          lineno(-1) {}
 
 
 public:
@@ -162,6 +164,9 @@ public:
 
     unsigned int getId() const { return id; }
 
+    int getLineno() const { return lineno; }
+    void setLineno(int lineno) { this->lineno = lineno; }
+
     void parseLocationMap(StackMap::Record* r, LocationMap* map);
 
     int totalStackmapArgs() { return frameStackmapArgsStart() + numFrameStackmapArgs(); }
@@ -0,0 +1,204 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "codegen/profiling/alloc_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "codegen/profiling/sampling_profiler.h"
+#include "core/threading.h"
+#include "core/types.h"
+#include "runtime/types.h"
+
+// All of this state is guarded by the GIL: objects only get created and freed with it held.
+extern "C" {
+Py_ssize_t _PyAlloc_BytesUntilSample = PY_SSIZE_T_MAX;
+Py_ssize_t _PyAlloc_NumLiveSamples = 0;
+unsigned char _PyAlloc_LiveFilter[_PYALLOC_FILTER_SIZE];
+}
+
+namespace pyston {
+
+bool alloc_profiler_running = false;
+
+namespace {
+
+// Deeper stacks get truncated to their innermost frames.
+#define MAX_ALLOC_STACK_DEPTH 128
+
+struct AllocTotals {
+    uint64_t samples = 0;
+    double count = 0, bytes = 0;
+};
+
+struct LiveSample {
+    const std::string* type;
+    const std::string* stack;
+    double count, bytes;
+};
+
+typedef std::pair<const std::string*, const std::string*> AllocKey;
+
+static int64_t sample_interval;
+static std::mt19937_64 rng;
+
+// Interned, so that the tables below only have to store pointers.  Never cleared while the profiler has samples.
+static std::unordered_set<std::string> strings;
+
+static std::map<AllocKey, AllocTotals> totals;
+static std::unordered_map<void*, LiveSample> live_samples; // keyed by the start of the memory block
+
+static const std::string* intern(std::string s) {
+    return &*strings.insert(std::move(s)).first;
+}
+
+static void resetCountdown() {
+    std::exponential_distribution<double> gap(1.0 / sample_interval);
+    _PyAlloc_BytesUntilSample = std::max((Py_ssize_t)1, (Py_ssize_t)gap(rng));
+}
+
+static const std::string* currentStack() {
+    std::string key;
+    llvm::raw_string_ostream os(key);
+
+    FrameInfo* frames[MAX_ALLOC_STACK_DEPTH];
+    int depth = 0;
+    for (FrameInfo* f = (FrameInfo*)cur_thread_state.frame_info; f && depth < MAX_ALLOC_STACK_DEPTH; f = f->back)
+        frames[depth++] = f;
+
+    if (depth == 0)
+        os << "[native]";
+    for (int i = depth - 1; i >= 0; i--) {
+        printProfilerFrame(os, frames[i]->code, frames[i]->stmt_offset, frames[i]->tier);
+        if (i != 0)
+            os << ';';
+    }
+    os.flush();
+    return intern(std::move(key));
+}
+
+static void addLiveSample(void* block, const LiveSample& sample) {
+    auto r = live_samples.insert(std::make_pair(block, sample));
+    if (!r.second) {
+        // The previous object in this block got freed without us noticing (eg it was sitting in a free list):
+        r.first->second = sample;
+        return;
+    }
+
+    unsigned char& bucket = _PyAlloc_LiveFilter[_PYALLOC_FILTER_IDX(block)];
+    // Saturated buckets stay that way until the next reset:
+    if (bucket != 255)
+        bucket++;
+    _PyAlloc_NumLiveSamples++;
+}
+
+static void resetLiveSamples() {
+    live_samples.clear();
+    memset(_PyAlloc_LiveFilter, 0, sizeof(_PyAlloc_LiveFilter));
+    _PyAlloc_NumLiveSamples = 0;
+}
+
+static std::vector<AllocationProfileEntry> sortedEntries(const std::map<AllocKey, AllocTotals>& table) {
+    std::vector<AllocationProfileEntry> rtn;
+    rtn.reserve(table.size());
+    for (auto&& p : table)
+        rtn.push_back(
+            AllocationProfileEntry{ *p.first.first, *p.first.second, p.second.samples, p.second.count, p.second.bytes });
+    std::sort(rtn.begin(), rtn.end(), [](const AllocationProfileEntry& lhs, const AllocationProfileEntry& rhs) {
+        return lhs.bytes > rhs.bytes;
+    });
+    return rtn;
+}
+}
+
+extern "C" void _PyAlloc_Sample(PyObject* op) noexcept {
+    if (!alloc_profiler_running) {
+        // We only get here when the counter wrapped all the way around while the profiler was off.
+        _PyAlloc_BytesUntilSample = PY_SSIZE_T_MAX;
+        return;
+    }
+
+    resetCountdown();
+
+    BoxedClass* cls = op->cls;
+    Py_ssize_t basic_size = cls->tp_basicsize;
+    // The countdown only saw the basic size, so that's what the probability of getting sampled depends on:
+    double weight = 1.0 / -std::expm1(-(double)basic_size / sample_interval);
+    Py_ssize_t size = cls->tp_itemsize ? _PyObject_VAR_SIZE(cls, Py_SIZE(op)) : basic_size;
+
+    AllocKey key(intern(cls->tp_name ? cls->tp_name : "?"), currentStack());
+    AllocTotals& t = totals[key];
+    t.samples++;
+    t.count += weight;
+    t.bytes += weight * size;
+
+    void* block = PyType_IS_GC(cls) ? (void*)((PyGC_Head*)op - 1) : (void*)op;
+    addLiveSample(block, LiveSample{ key.first, key.second, weight, weight * size });
+}
+
+extern "C" void _PyAlloc_ForgetBlock(void* block) noexcept {
+    auto it = live_samples.find(block);
+    if (it == live_samples.end())
+        return;
+    live_samples.erase(it);
+
+    unsigned char& bucket = _PyAlloc_LiveFilter[_PYALLOC_FILTER_IDX(block)];
+    if (bucket != 255)
+        bucket--;
+    _PyAlloc_NumLiveSamples--;
+}
+
+void startAllocationProfiler(int64_t interval_bytes) {
+    RELEASE_ASSERT(interval_bytes > 0, "");
+
+    totals.clear();
+    resetLiveSamples();
+    strings.clear();
+
+    sample_interval = interval_bytes;
+    alloc_profiler_running = true;
+    resetCountdown();
+}
+
+void stopAllocationProfiler() {
+    alloc_profiler_running = false;
+    _PyAlloc_BytesUntilSample = PY_SSIZE_T_MAX;
+}
+
+std::vector<AllocationProfileEntry> getAllocationProfile(bool clear) {
+    std::vector<AllocationProfileEntry> rtn = sortedEntries(totals);
+    if (clear)
+        totals.clear();
+    return rtn;
+}
+
+std::vector<AllocationProfileEntry> getLiveAllocations() {
+    std::map<AllocKey, AllocTotals> table;
+    for (auto&& p : live_samples) {
+        AllocTotals& t = table[AllocKey(p.second.type, p.second.stack)];
+        t.samples++;
+        t.count += p.second.count;
+        t.bytes += p.second.bytes;
+    }
+    return sortedEntries(table);
+}
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYSTON_CODEGEN_PROFILING_ALLOCPROFILER_H
+#define PYSTON_CODEGEN_PROFILING_ALLOCPROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace pyston {
+
+// A runtime-toggleable, sampled allocation profiler.
+//
+// The hook sits in _Py_NewReference (see object.h), so it sees every object no matter which allocation path created
+// it.  We sample on average once every `interval_bytes` bytes of objects, with exponentially distributed gaps so that
+// the samples don't alias with allocation patterns, and record the class and the Python-level stack (in the format
+// of the sampling profiler) of the sampled object.  Every sample stands for 1 / P(sampled) objects of its size, so the
+// counts and byte totals we report are unbiased estimates.
+//
+// Sampled objects also get tracked until their memory gets freed, which is what getLiveAllocations() reports: the
+// allocation sites of the memory that's still in use, ie where a growing heap is coming from.
+//
+// Caveats: the sampling countdown only uses the basic size of each object (the variable-size part isn't known yet when
+// the hook runs), and objects that end up in a free list instead of getting freed keep counting as live until their
+// memory gets reused by another sampled object or freed.
+
+void startAllocationProfiler(int64_t interval_bytes);
+// Stops taking new samples, but keeps tracking the live ones.
+void stopAllocationProfiler();
+
+struct AllocationProfileEntry {
+    std::string type, stack;
+    uint64_t samples;
+    double count, bytes; // estimates
+};
+
+// Sorted by decreasing number of bytes.
+std::vector<AllocationProfileEntry> getAllocationProfile(bool clear);
+std::vector<AllocationProfileEntry> getLiveAllocations();
+
+extern bool alloc_profiler_running;
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "codegen/profiling/deopt_trace.h"
+
+#include <algorithm>
+#include <ctime>
+#include <deque>
+#include <tuple>
+
+namespace pyston {
+
+typedef std::tuple<std::string, std::string, int, std::string, std::string> DeoptSiteKey;
+
+// All of this is guarded by the GIL.
+static std::deque<DeoptEvent> events;
+static std::map<DeoptSiteKey, DeoptSite> sites;
+
+void logDeopt(DeoptEvent event) {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    event.time = ts.tv_sec + ts.tv_nsec * 1e-9;
+
+    if (event.kind == DeoptKind::DEOPT) {
+        DeoptSite& site
+            = sites[std::make_tuple(event.filename, event.name, event.lineno, event.node, event.expected_cls)];
+        if (site.count == 0) {
+            site.name = event.name;
+            site.filename = event.filename;
+            site.lineno = event.lineno;
+            site.node = event.node;
+            site.expected_cls = event.expected_cls;
+        }
+        site.count++;
+        site.actual_classes[event.actual_cls]++;
+    }
+
+    if (events.size() == MAX_DEOPT_EVENTS)
+        events.pop_front();
+    events.push_back(std::move(event));
+}
+
+std::vector<DeoptEvent> getDeoptEvents(bool clear) {
+    std::vector<DeoptEvent> rtn(events.begin(), events.end());
+    if (clear)
+        events.clear();
+    return rtn;
+}
+
+std::vector<DeoptSite> getDeoptSites(bool clear) {
+    std::vector<DeoptSite> rtn;
+    rtn.reserve(sites.size());
+    for (auto&& p : sites)
+        rtn.push_back(p.second);
+    std::stable_sort(rtn.begin(), rtn.end(),
+                     [](const DeoptSite& lhs, const DeoptSite& rhs) { return lhs.count > rhs.count; });
+    if (clear)
+        sites.clear();
+    return rtn;
+}
+}
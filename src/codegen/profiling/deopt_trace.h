@@ -0,0 +1,69 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYSTON_CODEGEN_PROFILING_DEOPTTRACE_H
+#define PYSTON_CODEGEN_PROFILING_DEOPTTRACE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "core/types.h"
+
+namespace pyston {
+
+// A trace of the transitions between the interpreter and the llvm tier, so that we can tell why a hot function keeps
+// ending up back in the interpreter.
+//
+// Every failed type guard in llvm-compiled code (ie every call to deopt()) records an event, with the statement the
+// guard was in, the class the guard expected and the class it got.  Those are also aggregated per guard site, since
+// the event list only keeps the most recent ones.  Every OSR from the interpreter or baseline jit into the llvm tier
+// records an event too.
+
+enum class DeoptKind {
+    DEOPT, // a speculation failed, and we continued in the interpreter
+    OSR,   // a loop got hot, and we jumped into llvm-compiled code in the middle of the function
+};
+
+struct DeoptEvent {
+    double time; // wall clock, in seconds since the epoch; filled in by logDeopt()
+    DeoptKind kind;
+    std::string name, filename;
+    int lineno;
+    const char* node; // the type of the BST statement
+    std::string expected_cls, actual_cls; // empty for OSRs
+    FrameTier from_tier, to_tier;
+    int effort; // the EffortLevel of the llvm version we left (or entered, for OSRs)
+    bool version_invalidated; // whether this deopt made us throw away the llvm version
+};
+
+struct DeoptSite {
+    std::string name, filename;
+    int lineno;
+    const char* node;
+    std::string expected_cls;
+    uint64_t count = 0;
+    std::map<std::string, uint64_t> actual_classes; // how often the guard saw each class instead
+};
+
+void logDeopt(DeoptEvent event);
+
+// Returns the events recorded since the last clear, oldest first.  Only the last MAX_DEOPT_EVENTS ones are kept.
+#define MAX_DEOPT_EVENTS 10000
+std::vector<DeoptEvent> getDeoptEvents(bool clear);
+// Only covers DEOPT events, sorted by decreasing count.
+std::vector<DeoptSite> getDeoptSites(bool clear);
+}
+
+#endif
@@ -0,0 +1,129 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "codegen/profiling/jit_events.h"
+
+#include <cstdio>
+#include <ctime>
+#include <deque>
+
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace pyston {
+
+// All of this is guarded by the GIL (compiles happen with it held).
+static std::deque<JitCompileEvent> events;
+static JitCompileTotals totals[3];
+static FILE* log_file;
+
+const char* jitCompileReasonName(JitCompileReason reason) {
+    switch (reason) {
+        case JitCompileReason::TIERUP:
+            return "tierup";
+        case JitCompileReason::RESPECIALIZE:
+            return "respecialize";
+        case JitCompileReason::SPECULATION_FAILURE:
+            return "speculation_failure";
+        case JitCompileReason::OSR:
+            return "osr";
+        case JitCompileReason::REOPT:
+            return "reopt";
+    }
+    return "?";
+}
+
+static void writeJSONString(llvm::raw_ostream& os, llvm::StringRef s) {
+    os << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+            os << llvm::format("\\u%04x", c);
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+static void writeEvent(const JitCompileEvent& e) {
+    std::string line;
+    llvm::raw_string_ostream os(line);
+    os << "{\"time\": " << llvm::format("%.6f", e.time);
+    os << ", \"tier\": \"" << (e.tier == FrameTier::LLVM ? "llvm" : "bjit") << "\"";
+    os << ", \"effort\": " << e.effort;
+    os << ", \"reason\": \"" << jitCompileReasonName(e.reason) << "\"";
+    os << ", \"name\": ";
+    writeJSONString(os, e.name);
+    os << ", \"filename\": ";
+    writeJSONString(os, e.filename);
+    os << ", \"firstlineno\": " << e.firstlineno;
+    os << ", \"block\": ";
+    if (e.block_idx != -1)
+        os << e.block_idx;
+    else
+        os << "null";
+    os << ", \"ir_size\": " << e.ir_size;
+    os << ", \"compile_us\": " << e.compile_us;
+    os << ", \"code_size\": " << e.code_size;
+    os << ", \"object_cache_hit\": " << (e.object_cache_hit ? "true" : "false") << "}\n";
+    os.flush();
+
+    fwrite(line.data(), 1, line.size(), log_file);
+    // Compiles are rare enough that we can afford to make every event visible to tail -f right away:
+    fflush(log_file);
+}
+
+void logJitCompile(JitCompileEvent event) {
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    event.time = ts.tv_sec + ts.tv_nsec * 1e-9;
+
+    JitCompileTotals& t = totals[(int)event.tier];
+    t.num_compiles++;
+    t.compile_us += event.compile_us;
+    t.code_size += event.code_size;
+
+    if (log_file)
+        writeEvent(event);
+
+    if (events.size() == MAX_JIT_EVENTS)
+        events.pop_front();
+    events.push_back(std::move(event));
+}
+
+std::vector<JitCompileEvent> getJitCompileEvents(bool clear) {
+    std::vector<JitCompileEvent> rtn(events.begin(), events.end());
+    if (clear)
+        events.clear();
+    return rtn;
+}
+
+const JitCompileTotals& getJitCompileTotals(FrameTier tier) {
+    return totals[(int)tier];
+}
+
+bool setJitEventLogFile(const char* path) {
+    if (log_file) {
+        fclose(log_file);
+        log_file = NULL;
+    }
+
+    if (!path)
+        return true;
+
+    log_file = fopen(path, "ae");
+    return log_file != NULL;
+}
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYSTON_CODEGEN_PROFILING_JITEVENTS_H
+#define PYSTON_CODEGEN_PROFILING_JITEVENTS_H
+
+#include <string>
+#include <vector>
+
+#include "core/types.h"
+
+namespace pyston {
+
+// A log of everything the jits compile, meant for finding out which functions cause compilation storms.
+//
+// Every llvm compile (in compileFunction()) and every block the baseline jit assembles records one event.  The most
+// recent events are kept in memory, and if a log file is set (with setJitEventLogFile() or the PYSTON_JIT_EVENT_LOG
+// environment variable), every event also gets appended to it as one line of JSON.  Cumulative per-tier totals are
+// kept for the whole life of the process.
+
+struct JitCompileEvent {
+    double time; // wall clock, in seconds since the epoch; filled in by logJitCompile()
+    FrameTier tier;
+    int effort; // the llvm EffortLevel, 0 for the baseline jit
+    JitCompileReason reason;
+    std::string name, filename;
+    int firstlineno;
+    int block_idx;      // the cfg block, for the baseline jit; -1 for llvm
+    int ir_size;        // number of llvm instructions, or of bytecode statements for the baseline jit
+    uint64_t compile_us;
+    uint64_t code_size; // bytes of machine code
+    bool object_cache_hit;
+};
+
+struct JitCompileTotals {
+    uint64_t num_compiles = 0;
+    uint64_t compile_us = 0;
+    uint64_t code_size = 0;
+};
+
+const char* jitCompileReasonName(JitCompileReason reason);
+
+void logJitCompile(JitCompileEvent event);
+
+// Returns the events recorded since the last clear, oldest first.  Only the last MAX_JIT_EVENTS ones are kept.
+#define MAX_JIT_EVENTS 10000
+std::vector<JitCompileEvent> getJitCompileEvents(bool clear);
+const JitCompileTotals& getJitCompileTotals(FrameTier tier);
+
+// Passing NULL stops writing to the file.  Returns false (with errno set) if the file can't be opened.
+bool setJitEventLogFile(const char* path);
+}
+
+#endif
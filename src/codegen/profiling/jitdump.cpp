@@ -0,0 +1,249 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "codegen/profiling/jitdump.h"
+
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "llvm/ADT/SmallVector.h"
+
+#include "core/options.h"
+#include "core/thread_utils.h"
+
+namespace pyston {
+
+namespace {
+
+enum JitdumpRecordType : uint32_t {
+    JIT_CODE_LOAD = 0,
+    JIT_CODE_DEBUG_INFO = 2,
+    JIT_CODE_CLOSE = 3,
+};
+
+struct JitdumpFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+};
+static_assert(sizeof(JitdumpFileHeader) == 40, "");
+
+struct JitdumpRecordHeader {
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+};
+
+struct JitdumpCodeLoad {
+    JitdumpRecordHeader header;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+    // followed by the NUL-terminated name and the code bytes
+};
+static_assert(sizeof(JitdumpCodeLoad) == 56, "");
+
+struct JitdumpDebugInfo {
+    JitdumpRecordHeader header;
+    uint64_t code_addr;
+    uint64_t nr_entry;
+    // followed by nr_entry entries, each of them being the fields below plus the NUL-terminated file name
+};
+
+struct JitdumpDebugEntry {
+    uint64_t addr;
+    uint32_t lineno;
+    uint32_t discrim;
+};
+static_assert(sizeof(JitdumpDebugEntry) == 16, "");
+
+#define EM_X86_64 62
+
+static threading::PthreadFastMutex jitdump_lock;
+static int jitdump_fd = -1;
+static void* jitdump_marker = NULL;
+static size_t jitdump_marker_size;
+static uint64_t next_code_index = 0;
+
+// perf has to be told to use the same clock: perf record -k mono
+static uint64_t timestamp() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+template <typename T> static void append(llvm::SmallVectorImpl<char>& buf, const T& data) {
+    buf.append((const char*)&data, (const char*)&data + sizeof(T));
+}
+
+static void appendString(llvm::SmallVectorImpl<char>& buf, llvm::StringRef s) {
+    buf.append(s.begin(), s.end());
+    buf.push_back('\0');
+}
+
+// Records have to be written out in one piece: perf inject may read the file while we are still appending to it.
+static void writeRecord(llvm::SmallVectorImpl<char>& buf) {
+    ((JitdumpRecordHeader*)buf.data())->total_size = buf.size();
+
+    const char* p = buf.data();
+    size_t left = buf.size();
+    while (left) {
+        ssize_t r = write(jitdump_fd, p, left);
+        if (r < 0 && errno == EINTR)
+            continue;
+        RELEASE_ASSERT(r > 0, "writing the jitdump file failed: %s", strerror(errno));
+        p += r;
+        left -= r;
+    }
+}
+
+static void openJitdump();
+
+// Hold the lock across fork(), so that the child doesn't inherit a half-written record.
+static void jitdumpAtForkPrepare() {
+    jitdump_lock.lock();
+}
+
+static void jitdumpAtForkParent() {
+    jitdump_lock.unlock();
+}
+
+static void jitdumpAtForkChild() {
+    // perf looks for the records of a process in /tmp/jit-PID.dump under its own pid, so the child can't keep
+    // appending to the parent's file.  Code that got generated before the fork is only described in the parent's dump.
+    if (jitdump_fd != -1) {
+        munmap(jitdump_marker, jitdump_marker_size);
+        close(jitdump_fd);
+        openJitdump();
+    }
+    jitdump_lock.unlock();
+}
+
+// Needs jitdump_lock.
+static void openJitdump() {
+    static bool registered_atfork = false;
+    if (!registered_atfork) {
+        pthread_atfork(jitdumpAtForkPrepare, jitdumpAtForkParent, jitdumpAtForkChild);
+        registered_atfork = true;
+    }
+
+    char path[80];
+    snprintf(path, sizeof(path), "/tmp/jit-%d.dump", getpid());
+    jitdump_fd = open(path, O_CREAT | O_TRUNC | O_RDWR, 0666);
+    RELEASE_ASSERT(jitdump_fd != -1, "couldn't open %s: %s", path, strerror(errno));
+
+    // perf finds the dump by looking for an executable mapping of a file with this name, so this mapping has to stay
+    // around until we are done.
+    jitdump_marker_size = sysconf(_SC_PAGESIZE);
+    jitdump_marker = mmap(NULL, jitdump_marker_size, PROT_READ | PROT_EXEC, MAP_PRIVATE, jitdump_fd, 0);
+    RELEASE_ASSERT(jitdump_marker != MAP_FAILED, "%s", strerror(errno));
+
+    JitdumpFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = 0x4A695444; // "JiTD"
+    header.version = 1;
+    header.total_size = sizeof(header);
+    header.elf_mach = EM_X86_64;
+    header.pid = getpid();
+    header.timestamp = timestamp();
+
+    ssize_t r = write(jitdump_fd, &header, sizeof(header));
+    RELEASE_ASSERT(r == sizeof(header), "writing the jitdump file failed: %s", strerror(errno));
+}
+}
+
+void jitdumpCodeLoad(llvm::StringRef name, void* code_addr, uint64_t code_size, llvm::StringRef filename,
+                     llvm::ArrayRef<JitdumpLineEntry> lines) {
+    assert(PERF_JITDUMP);
+    if (!code_size)
+        return;
+
+    LOCK_REGION(&jitdump_lock);
+    if (jitdump_fd == -1) {
+        // We already closed the file.
+        if (jitdump_marker)
+            return;
+        openJitdump();
+    }
+
+    uint64_t now = timestamp();
+    llvm::SmallVector<char, 512> buf;
+
+    // The debug info has to come before the load record it describes.
+    if (!lines.empty()) {
+        JitdumpDebugInfo info;
+        info.header.id = JIT_CODE_DEBUG_INFO;
+        info.header.timestamp = now;
+        info.code_addr = (uint64_t)code_addr;
+        info.nr_entry = lines.size();
+        append(buf, info);
+        for (const JitdumpLineEntry& line : lines) {
+            JitdumpDebugEntry entry;
+            entry.addr = (uint64_t)line.addr;
+            entry.lineno = line.lineno;
+            entry.discrim = 0;
+            append(buf, entry);
+            appendString(buf, filename);
+        }
+        writeRecord(buf);
+        buf.clear();
+    }
+
+    JitdumpCodeLoad load;
+    load.header.id = JIT_CODE_LOAD;
+    load.header.timestamp = now;
+    load.pid = getpid();
+    load.tid = syscall(SYS_gettid);
+    load.vma = (uint64_t)code_addr;
+    load.code_addr = (uint64_t)code_addr;
+    load.code_size = code_size;
+    load.code_index = next_code_index++;
+    append(buf, load);
+    appendString(buf, name);
+    buf.append((const char*)code_addr, (const char*)code_addr + code_size);
+    writeRecord(buf);
+}
+
+void jitdumpClose() {
+    LOCK_REGION(&jitdump_lock);
+    if (jitdump_fd == -1)
+        return;
+
+    llvm::SmallVector<char, sizeof(JitdumpRecordHeader)> buf;
+    JitdumpRecordHeader close_record;
+    close_record.id = JIT_CODE_CLOSE;
+    close_record.timestamp = timestamp();
+    append(buf, close_record);
+    writeRecord(buf);
+
+    // Keep jitdump_marker set, so that code that gets freed during shutdown doesn't reopen (and truncate) the file.
+    munmap(jitdump_marker, jitdump_marker_size);
+    close(jitdump_fd);
+    jitdump_fd = -1;
+}
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYSTON_CODEGEN_PROFILING_JITDUMP_H
+#define PYSTON_CODEGEN_PROFILING_JITDUMP_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "core/common.h"
+
+namespace pyston {
+
+// Support for perf's jitdump format (tools/perf/Documentation/jitdump-specification.txt), enabled by -J.
+//
+// Every piece of machine code we generate gets written to /tmp/jit-PID.dump as soon as it becomes executable,
+// together with a copy of its bytes and, where we know them, the Python source lines.  Unlike the perf map that
+// -p writes at exit, this covers code that gets freed or overwritten while the process runs: perf attributes each
+// sample to the newest record for the address at the sample's timestamp.  To use it:
+//
+//   perf record -k mono -g ./pyston -J script.py
+//   perf inject --jit -i perf.data -o perf.jit.data
+//   perf report -i perf.jit.data
+
+struct JitdumpLineEntry {
+    void* addr;
+    int lineno;
+};
+
+// Callers check PERF_JITDUMP first, so that names only get built when they are needed.
+void jitdumpCodeLoad(llvm::StringRef name, void* code_addr, uint64_t code_size, llvm::StringRef filename = "",
+                     llvm::ArrayRef<JitdumpLineEntry> lines = {});
+void jitdumpClose();
+}
+
+#endif
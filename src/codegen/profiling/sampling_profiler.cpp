@@ -0,0 +1,314 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "codegen/profiling/sampling_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/time.h>
+#include <unordered_map>
+#include <vector>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "core/bst.h"
+#include "core/cfg.h"
+#include "core/thread_utils.h"
+#include "core/threading.h"
+#include "core/types.h"
+#include "runtime/types.h"
+
+namespace pyston {
+
+bool sampling_profiler_running = false;
+volatile int sampling_profiler_drain_requested = 0;
+
+const char* tierName(FrameTier tier) {
+    switch (tier) {
+        case FrameTier::INTERPRETER:
+            return "interp";
+        case FrameTier::BASELINE_JIT:
+            return "bjit";
+        case FrameTier::LLVM:
+            return "llvm";
+    }
+    return "?";
+}
+
+namespace {
+
+struct SampleEntry {
+    BoxedCode* code; // NULL for the header entry that starts every sample
+    int stmt_offset; // in the header entry: the number of frame entries that follow
+    FrameTier tier;
+};
+
+// Deeper stacks get truncated to their innermost frames.
+#define MAX_SAMPLE_DEPTH 128
+
+// Single producer, single consumer: only the signal handler running on the owning thread pushes, and pops only
+// happen with the GIL held.
+class SampleRing {
+public:
+    static const int SIZE = 4096; // in entries; has to be a power of two
+
+    std::atomic<uint64_t> head, tail;
+    SampleEntry entries[SIZE];
+
+    SampleRing() : head(0), tail(0) {}
+
+    SampleEntry& at(uint64_t idx) { return entries[idx & (SIZE - 1)]; }
+
+    // Async-signal-safe.  Returns false if the sample didn't fit.
+    bool push(FrameInfo* frame_info) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t t = tail.load(std::memory_order_acquire);
+
+        int depth = 0;
+        for (FrameInfo* f = frame_info; f && depth < MAX_SAMPLE_DEPTH; f = f->back)
+            depth++;
+
+        if (h + depth + 1 - t > SIZE)
+            return false;
+
+        at(h) = SampleEntry{ NULL, depth, FrameTier::INTERPRETER };
+        FrameInfo* f = frame_info;
+        for (int i = 1; i <= depth; i++, f = f->back)
+            at(h + i) = SampleEntry{ f->code, f->stmt_offset, f->tier };
+
+        head.store(h + depth + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool needsDrain() {
+        return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed) > SIZE / 2;
+    }
+};
+
+struct ThreadSamples {
+    // Only allocated once the profiler gets started.
+    std::atomic<SampleRing*> ring;
+
+    ThreadSamples() : ring(NULL) {}
+};
+
+static __thread ThreadSamples* current_thread_samples = NULL;
+
+static threading::PthreadFastMutex registry_lock;
+static std::vector<ThreadSamples*> all_thread_samples; // guarded by registry_lock
+
+// The results; guarded by the GIL.
+static std::unordered_map<std::string, uint64_t> aggregated_stacks;
+
+static std::atomic<uint64_t> num_native_samples(0);
+static std::atomic<uint64_t> num_dropped_samples(0);
+static uint64_t num_dropped_samples_logged = 0; // guarded by the GIL
+
+// Needs the GIL and registry_lock.
+static void drainRing(SampleRing* ring) {
+    uint64_t t = ring->tail.load(std::memory_order_relaxed);
+    uint64_t h = ring->head.load(std::memory_order_acquire);
+
+    std::string key;
+    while (t < h) {
+        int depth = ring->at(t).stmt_offset;
+        assert(ring->at(t).code == NULL);
+        assert(depth > 0 && depth <= MAX_SAMPLE_DEPTH);
+
+        key.clear();
+        llvm::raw_string_ostream os(key);
+        // The ring has the innermost frame first, collapsed stacks start with the outermost one:
+        for (int i = depth; i >= 1; i--) {
+            const SampleEntry& e = ring->at(t + i);
+            printProfilerFrame(os, e.code, e.stmt_offset, e.tier);
+            if (i != 1)
+                os << ';';
+        }
+        os.flush();
+        aggregated_stacks[key]++;
+
+        t += depth + 1;
+    }
+
+    ring->tail.store(t, std::memory_order_release);
+}
+
+static void handleSigprof(int signum, siginfo_t* info, void* ucontext) {
+    if (!sampling_profiler_running)
+        return;
+
+    int saved_errno = errno;
+
+    FrameInfo* frame_info = (FrameInfo*)cur_thread_state.frame_info;
+    ThreadSamples* samples = current_thread_samples;
+    SampleRing* ring = samples ? samples->ring.load(std::memory_order_acquire) : NULL;
+
+    if (!frame_info) {
+        num_native_samples++;
+    } else if (!ring || !ring->push(frame_info)) {
+        num_dropped_samples++;
+    } else if (ring->needsDrain() && !sampling_profiler_drain_requested) {
+        // Have whichever thread next checks for pending calls drain everybody's ring.  Not a Py_AddPendingCall,
+        // since those only run on the main thread, which could be blocked while the others keep filling their rings.
+        sampling_profiler_drain_requested = 1;
+        _stop_thread = 1;
+    }
+
+    errno = saved_errno;
+}
+}
+
+void printProfilerFrame(llvm::raw_ostream& os, BoxedCode* code, int stmt_offset, FrameTier tier) {
+    if (!code) {
+        os << "? [" << tierName(tier) << "]";
+        return;
+    }
+
+    int lineno = code->firstlineno;
+    if (stmt_offset != -1 && code->source && code->source->cfg)
+        lineno = code->source->cfg->getStmtFromOffset(stmt_offset)->lineno;
+
+    os << (code->name ? code->name->s() : "?") << " (" << (code->filename ? code->filename->s() : "?") << ":"
+       << lineno << ") [" << tierName(tier) << "]";
+}
+
+void drainSamplingProfiler() {
+    {
+        LOCK_REGION(&registry_lock);
+        for (ThreadSamples* samples : all_thread_samples) {
+            SampleRing* ring = samples->ring.load(std::memory_order_relaxed);
+            if (ring)
+                drainRing(ring);
+        }
+    }
+
+    // The signal handler can't log stats itself:
+    static StatCounter num_dropped("num_sampling_profiler_dropped_samples");
+    uint64_t dropped = num_dropped_samples.load();
+    num_dropped.log(dropped - num_dropped_samples_logged);
+    num_dropped_samples_logged = dropped;
+}
+
+void drainSamplingProfilerIfRequested() {
+    sampling_profiler_drain_requested = 0;
+    if (sampling_profiler_running)
+        drainSamplingProfiler();
+}
+
+void startSamplingProfiler(int interval_us) {
+    RELEASE_ASSERT(interval_us > 0, "");
+
+    {
+        LOCK_REGION(&registry_lock);
+        for (ThreadSamples* samples : all_thread_samples) {
+            SampleRing* ring = samples->ring.load(std::memory_order_relaxed);
+            if (ring) {
+                // Throw away anything that a straggling signal pushed after the last stop; the code objects
+                // those samples point to might be gone.
+                ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+            } else {
+                samples->ring.store(new SampleRing(), std::memory_order_release);
+            }
+        }
+        sampling_profiler_running = true;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handleSigprof;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    int r = sigaction(SIGPROF, &action, NULL);
+    RELEASE_ASSERT(r == 0, "%s", strerror(errno));
+
+    struct itimerval timer;
+    timer.it_value.tv_sec = timer.it_interval.tv_sec = interval_us / 1000000;
+    timer.it_value.tv_usec = timer.it_interval.tv_usec = interval_us % 1000000;
+    r = setitimer(ITIMER_PROF, &timer, NULL);
+    RELEASE_ASSERT(r == 0, "%s", strerror(errno));
+}
+
+void stopSamplingProfiler() {
+    if (!sampling_profiler_running)
+        return;
+
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, NULL);
+
+    drainSamplingProfiler();
+    sampling_profiler_running = false;
+}
+
+std::string getSamplingProfile(bool clear) {
+    if (sampling_profiler_running)
+        drainSamplingProfiler();
+
+    std::string rtn;
+    llvm::raw_string_ostream os(rtn);
+    for (auto&& p : aggregated_stacks)
+        os << p.first << ' ' << p.second << '\n';
+    if (num_native_samples)
+        os << "[native] " << num_native_samples.load() << '\n';
+    if (num_dropped_samples)
+        os << "[dropped] " << num_dropped_samples.load() << '\n';
+    os.flush();
+
+    if (clear) {
+        aggregated_stacks.clear();
+        num_native_samples = 0;
+        num_dropped_samples = 0;
+        num_dropped_samples_logged = 0;
+    }
+    return rtn;
+}
+
+void registerSamplingProfilerThread() {
+    assert(!current_thread_samples);
+
+    ThreadSamples* samples = new ThreadSamples();
+    {
+        LOCK_REGION(&registry_lock);
+        if (sampling_profiler_running)
+            samples->ring.store(new SampleRing(), std::memory_order_relaxed);
+        all_thread_samples.push_back(samples);
+    }
+
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    current_thread_samples = samples;
+}
+
+void unregisterSamplingProfilerThread() {
+    ThreadSamples* samples = current_thread_samples;
+    if (!samples)
+        return;
+
+    // From here on our signal handler won't touch the ring anymore:
+    current_thread_samples = NULL;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+
+    LOCK_REGION(&registry_lock);
+    SampleRing* ring = samples->ring.load(std::memory_order_relaxed);
+    if (ring) {
+        if (sampling_profiler_running)
+            drainRing(ring);
+        delete ring;
+    }
+    all_thread_samples.erase(std::find(all_thread_samples.begin(), all_thread_samples.end(), samples));
+    delete samples;
+}
+}
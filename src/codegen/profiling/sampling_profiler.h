@@ -0,0 +1,68 @@
+// Copyright (c) 2014-2016 Dropbox, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PYSTON_CODEGEN_PROFILING_SAMPLINGPROFILER_H
+#define PYSTON_CODEGEN_PROFILING_SAMPLINGPROFILER_H
+
+#include <string>
+
+#include "core/common.h"
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace pyston {
+
+class BoxedCode;
+enum class FrameTier : int;
+
+// A low-overhead, runtime-toggleable sampling profiler.
+//
+// An ITIMER_PROF signal handler walks the FrameInfo chain of the interrupted thread (no unwinding) and pushes
+// the (code, statement, tier) of every frame into a lock-free ring buffer owned by that thread.  The rings get
+// drained into an aggregate table with the GIL held: from a pending call once a ring fills up, when someone asks
+// for the results, and before a code object gets freed (so that undrained samples never point to a dead one).
+
+void startSamplingProfiler(int interval_us);
+void stopSamplingProfiler();
+
+// Returns the stacks sampled so far in collapsed-stack format (the input format of flamegraph.pl): one line per
+// distinct stack, with the frames listed outermost first and separated by ';', followed by the number of samples.
+std::string getSamplingProfile(bool clear);
+
+// Hooks for the threading code; must be called from the thread itself.  Unregistering needs the GIL.
+void registerSamplingProfilerThread();
+void unregisterSamplingProfilerThread();
+
+// Prints one frame the way it shows up in the collapsed stacks: "name (file:line) [tier]".  code may be NULL.
+void printProfilerFrame(llvm::raw_ostream& os, BoxedCode* code, int stmt_offset, FrameTier tier);
+
+// The short name of a tier ("interp", "bjit" or "llvm"), as used in the profiles and the jit/deopt traces.
+const char* tierName(FrameTier tier);
+
+extern bool sampling_profiler_running;
+void drainSamplingProfiler();
+
+// Set by the signal handler once a ring is half full.  Py_MakePendingCalls then calls
+// drainSamplingProfilerIfRequested() on whichever thread gets there first, not only on the main thread.
+extern volatile int sampling_profiler_drain_requested;
+void drainSamplingProfilerIfRequested();
+inline void samplingProfilerBeforeCodeFree() {
+    if (unlikely(sampling_profiler_running))
+        drainSamplingProfiler();
+}
+}
+
+#endif
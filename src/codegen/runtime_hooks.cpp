@@ -327,6 +327,10 @@ void initGlobalFuncs(GlobalState& g) {
     GET(mod_float_float);
     GET(pow_float_float);
 
+    GET(add_i64_i64);
+    GET(sub_i64_i64);
+    GET(mul_i64_i64);
+
     GET(dump);
 
 #ifdef Py_TRACE_REFS
@@ -57,6 +57,7 @@ struct GlobalFuncs {
     llvm::Value* checkRefs, *xdecrefAndRethrow;
 
     llvm::Value* div_float_float, *floordiv_float_float, *mod_float_float, *pow_float_float;
+    llvm::Value* add_i64_i64, *sub_i64_i64, *mul_i64_i64;
 
     llvm::Value* dump;
 
@@ -35,6 +35,7 @@
 #include "codegen/compvars.h"
 #include "codegen/irgen/hooks.h"
 #include "codegen/irgen/irgenerator.h"
+#include "codegen/profiling/jitdump.h"
 #include "codegen/stackmaps.h"
 #include "core/cfg.h"
 #include "core/util.h"
@@ -251,6 +252,14 @@ public:
             g.cur_cf->code_start = func_addr;
             g.cur_cf->code_size = Size;
             cf_registry.registerCF(g.cur_cf);
+
+            if (PERF_JITDUMP) {
+                llvm::SmallVector<JitdumpLineEntry, 32> jitdump_lines;
+                for (auto&& line : lines)
+                    jitdump_lines.push_back(JitdumpLineEntry{ (void*)line.first, (int)line.second.Line });
+                jitdumpCodeLoad(("llvm:" + Name).str(), (void*)func_addr, Size,
+                                lines.empty() ? "" : lines[0].second.FileName, jitdump_lines);
+            }
         }
 
         assert(func_addr);
@@ -591,7 +600,7 @@ public:
                 auto unwind_session_state = pause();
 
                 if (prev_frame_info)
-                    deinitFrame(prev_frame_info);
+                    deinitFrame(prev_frame_info, NULL);
 
                 // check decref info and decref locations when available
                 if (decref_info_iter != decref_infos.end()) {
@@ -638,6 +647,14 @@ public:
                 // TODO: shouldn't fetch this multiple times?
                 ++frame_iter.getFrameInfo()->code->cxx_exception_count[frame_iter.getCurrentStatement()];
                 exceptionAtLine(&exc_info.traceback);
+
+                if (unlikely(_Py_TracingPossible)) {
+                    // the trace function can run arbitrary code, so we have to pause unwinding like above
+                    auto unwind_session_state = pause();
+                    const ExcInfo& e = std::get<1>(unwind_session_state);
+                    traceFrameException(std::get<0>(unwind_session_state), e.type, e.value, e.traceback);
+                    resume(std::move(unwind_session_state));
+                }
             } else
                 getIsReraiseFlag() = false;
         }
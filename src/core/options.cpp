@@ -35,6 +35,7 @@ bool ENABLE_BASELINEJIT = true;
 bool CONTINUE_AFTER_FATAL = false;
 bool SHOW_DISASM = false;
 bool PROFILE = false;
+bool PERF_JITDUMP = false;
 bool DUMPJIT = false;
 bool USE_STRIPPED_STDLIB = true; // always true
 bool USE_REGALLOC_BASIC = false;
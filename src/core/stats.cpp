@@ -15,6 +15,12 @@
 #include "core/stats.h"
 
 #include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "core/thread_utils.h"
 
@@ -66,6 +72,22 @@ bool Stats::enabled;
 timespec Stats::start_ts;
 uint64_t Stats::start_tick;
 
+uint64_t Stats::slots[Stats::MAX_STATS];
+__thread std::atomic<uint64_t>** Stats::thread_chunks;
+
+namespace {
+struct StatsShard {
+    std::atomic<uint64_t>* chunks[Stats::MAX_STATS / Stats::CHUNK_SIZE];
+};
+}
+
+// Guards the name tables, the list of shards, the allocation of chunks, the slots, and the clear() baseline.  Readers
+// take it to make sure that the shards they are summing up don't go away; the increments don't take it.
+static threading::PthreadFastMutex stats_lock;
+static std::vector<StatsShard*>* all_shards;
+static uint64_t cleared_values[Stats::MAX_STATS];
+static int num_stats;
+
 StatCounter::StatCounter(const std::string& name) : counter(Stats::getStatCounter(name)) {
 }
 
@@ -75,31 +97,94 @@ StatPerThreadCounter::StatPerThreadCounter(const std::string& name) {
     counter = Stats::getStatCounter(buf);
 }
 
-static std::vector<uint64_t*>* counts;
 uint64_t* Stats::getStatCounter(const std::string& name) {
     // hacky but easy way of getting around static constructor ordering issues for now:
     static std::unordered_map<uint64_t*, std::string> names;
     Stats::names = &names;
     static std::unordered_map<std::string, uint64_t*> made;
-    // TODO: can do better than doing a malloc per counter:
-    static std::vector<uint64_t*> counts;
-    pyston::counts = &counts;
 
-    if (made.count(name))
-        return made[name];
+    LOCK_REGION(&stats_lock);
+
+    auto it = made.find(name);
+    if (it != made.end())
+        return it->second;
 
-    uint64_t* rtn = new uint64_t(0);
+    RELEASE_ASSERT(num_stats < MAX_STATS, "too many stats");
+    uint64_t* rtn = &slots[num_stats++];
     names[rtn] = name;
     made[name] = rtn;
-    counts.push_back(rtn);
     return rtn;
 }
 
-void Stats::clear() {
-    assert(counts);
-    for (auto p : *counts) {
-        *p = 0;
+std::atomic<uint64_t>* Stats::getChunkSlowpath(int chunk_idx) {
+    LOCK_REGION(&stats_lock);
+
+    if (!thread_chunks) {
+        static std::vector<StatsShard*> shards;
+        all_shards = &shards;
+
+        StatsShard* shard = new StatsShard();
+        memset(shard->chunks, 0, sizeof(shard->chunks));
+        shards.push_back(shard);
+        thread_chunks = shard->chunks;
+    }
+
+    std::atomic<uint64_t>* chunk = new std::atomic<uint64_t>[CHUNK_SIZE];
+    for (int i = 0; i < CHUNK_SIZE; i++)
+        chunk[i].store(0, std::memory_order_relaxed);
+    thread_chunks[chunk_idx] = chunk;
+    return chunk;
+}
+
+void Stats::unregisterThread() {
+#if STAT_PERF_COUNTERS
+    PerfCounters::closeThread();
+#endif
+
+    if (!thread_chunks)
+        return;
+
+    LOCK_REGION(&stats_lock);
+
+    StatsShard* shard = NULL;
+    for (auto it = all_shards->begin(); it != all_shards->end(); ++it) {
+        if ((*it)->chunks == thread_chunks) {
+            shard = *it;
+            all_shards->erase(it);
+            break;
+        }
+    }
+    assert(shard);
+    thread_chunks = NULL;
+
+    for (int c = 0; c < MAX_STATS / CHUNK_SIZE; c++) {
+        std::atomic<uint64_t>* chunk = shard->chunks[c];
+        if (!chunk)
+            continue;
+        for (int i = 0; i < CHUNK_SIZE; i++)
+            slots[c * CHUNK_SIZE + i] += chunk[i].load(std::memory_order_relaxed);
+        delete[] chunk;
+    }
+    delete shard;
+}
+
+// Needs stats_lock.
+uint64_t Stats::getTotal(int idx) {
+    uint64_t total = slots[idx];
+    if (!all_shards)
+        return total;
+    for (StatsShard* shard : *all_shards) {
+        std::atomic<uint64_t>* chunk = shard->chunks[idx / CHUNK_SIZE];
+        if (chunk)
+            total += chunk[idx % CHUNK_SIZE].load(std::memory_order_relaxed);
     }
+    return total;
+}
+
+void Stats::clear() {
+    LOCK_REGION(&stats_lock);
+    for (int i = 0; i < num_stats; i++)
+        cleared_values[i] = getTotal(i);
 }
 
 void Stats::startEstimatingCPUFreq() {
@@ -118,6 +203,33 @@ double Stats::estimateCPUFreq() {
     return (double)(end_tick - Stats::start_tick) * 1000 / wall_clock_ns;
 }
 
+static bool isTimerStat(const std::string& name) {
+    return startswith(name, "us_") || startswith(name, "_init_us_");
+}
+
+std::vector<std::pair<std::string, uint64_t>> Stats::snapshot(bool ticks_to_us) {
+    double cycles_per_us = ticks_to_us ? Stats::estimateCPUFreq() : 0;
+
+    std::vector<std::pair<std::string, uint64_t>> rtn;
+    {
+        LOCK_REGION(&stats_lock);
+        if (!names)
+            return rtn;
+
+        rtn.reserve(names->size());
+        for (const auto& p : *names) {
+            int idx = p.first - slots;
+            uint64_t count = getTotal(idx) - cleared_values[idx];
+            if (ticks_to_us && isTimerStat(p.second))
+                count = (uint64_t)(count / cycles_per_us);
+            rtn.push_back(make_pair(p.second, count));
+        }
+    }
+
+    std::sort(rtn.begin(), rtn.end());
+    return rtn;
+}
+
 void Stats::dump(bool includeZeros) {
     if (!Stats::enabled)
         return;
@@ -128,19 +240,14 @@ void Stats::dump(bool includeZeros) {
 
     fprintf(stderr, "Counters:\n");
 
-    std::vector<std::pair<std::string, uint64_t*>> pairs;
-    for (const auto& p : *names) {
-        pairs.push_back(make_pair(p.second, p.first));
-    }
-
-    std::sort(pairs.begin(), pairs.end());
+    std::vector<std::pair<std::string, uint64_t>> pairs = snapshot(false);
 
     uint64_t ticks_in_main = 0;
     uint64_t accumulated_stat_timer_ticks = 0;
     for (int i = 0; i < pairs.size(); i++) {
-        uint64_t count = *pairs[i].second;
+        uint64_t count = pairs[i].second;
         if (includeZeros || count > 0) {
-            if (startswith(pairs[i].first, "us_") || startswith(pairs[i].first, "_init_us_")) {
+            if (isTimerStat(pairs[i].first)) {
                 fprintf(stderr, "%s: %lu\n", pairs[i].first.c_str(), (uint64_t)(count / cycles_per_us));
 
             } else
@@ -157,6 +264,20 @@ void Stats::dump(bool includeZeros) {
     if (includeZeros || accumulated_stat_timer_ticks > 0)
         fprintf(stderr, "ticks_all_timers: %lu\n", accumulated_stat_timer_ticks);
 
+#if STAT_PERF_COUNTERS
+    std::unordered_map<std::string, uint64_t> by_name(pairs.begin(), pairs.end());
+    for (const auto& p : pairs) {
+        if (!startswith(p.first, "perf_") || !endswith(p.first, "_instructions") || !p.second)
+            continue;
+        std::string prefix = p.first.substr(0, p.first.size() - strlen("_instructions"));
+        double instructions = p.second;
+        fprintf(stderr, "%s: ipc %.2f, llc misses/1k instructions %.2f, branch misses/1k instructions %.2f\n",
+                prefix.c_str(), by_name[prefix + "_cycles"] ? instructions / by_name[prefix + "_cycles"] : 0.0,
+                by_name[prefix + "_llc_misses"] * 1000 / instructions,
+                by_name[prefix + "_branch_misses"] * 1000 / instructions);
+    }
+#endif
+
 #if 0
     // I want to enable this, but am leaving it disabled for the time
     // being because it causes test failures due to:
@@ -173,13 +294,226 @@ void Stats::dump(bool includeZeros) {
     fprintf(stderr, "(End of stats)\n");
 }
 
+static threading::PthreadFastMutex export_lock;
+static std::string export_path;
+static pid_t export_pid;
+static int export_fd = -1;
+static void* export_map;
+static size_t export_map_size;
+
+bool Stats::exportTo(const std::string& path) {
+    std::vector<std::pair<std::string, uint64_t>> stats = snapshot(true);
+
+    LOCK_REGION(&export_lock);
+
+    // A forked child shouldn't write into the file of its parent, even if it asks for the same path.
+    if (export_fd != -1 && (path != export_path || export_pid != getpid())) {
+        munmap(export_map, export_map_size);
+        close(export_fd);
+        export_fd = -1;
+    }
+
+    if (export_fd == -1) {
+        int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1)
+            return false;
+        export_fd = fd;
+        export_path = path;
+        export_pid = getpid();
+        export_map = NULL;
+        export_map_size = 0;
+    }
+
+    size_t needed = sizeof(StatsExportHeader) + stats.size() * sizeof(StatsExportEntry);
+    if (needed > export_map_size) {
+        // Leave some room so that we don't have to grow the file every time a new stat shows up:
+        size_t new_size = (needed + needed / 4 + 4095) & ~(size_t)4095;
+        if (ftruncate(export_fd, new_size) != 0)
+            return false;
+        void* new_map = mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, export_fd, 0);
+        if (new_map == MAP_FAILED)
+            return false;
+        if (export_map)
+            munmap(export_map, export_map_size);
+        export_map = new_map;
+        export_map_size = new_size;
+    }
+
+    StatsExportHeader* header = (StatsExportHeader*)export_map;
+    StatsExportEntry* entries = (StatsExportEntry*)(header + 1);
+
+    uint32_t seq = header->seq.load(std::memory_order_relaxed);
+    header->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(header->magic, "PYSTATS", 8);
+    header->version = 1;
+    header->num_entries = stats.size();
+    header->entry_size = sizeof(StatsExportEntry);
+    header->pid = export_pid;
+
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    header->timestamp_ns = ts.tv_sec * 1000000000UL + ts.tv_nsec;
+
+    for (int i = 0; i < stats.size(); i++) {
+        entries[i].value = stats[i].second;
+        strncpy(entries[i].name, stats[i].first.c_str(), sizeof(entries[i].name) - 1);
+        entries[i].name[sizeof(entries[i].name) - 1] = '\0';
+    }
+
+    header->seq.store(seq + 2, std::memory_order_release);
+    return true;
+}
+
 void Stats::endOfInit() {
-    std::unordered_map<uint64_t*, std::string> names_copy(names->begin(), names->end());
-    for (const auto& p : names_copy) {
-        uint64_t* init_id = getStatCounter("_init_" + p.second);
-        log(init_id, *p.first);
+    for (const auto& p : snapshot(false)) {
+        uint64_t* init_id = getStatCounter("_init_" + p.first);
+        log(init_id, p.second);
     }
 };
 
+#if STAT_PERF_COUNTERS
+struct PerfCounters::StatCounters {
+    uint64_t* events[NUM_EVENTS];
+};
+
+// Indexed like Stats::slots: the counters that the events of each timer get logged to.  Created lazily.
+static std::atomic<PerfCounters::StatCounters*> perf_stat_counters[Stats::MAX_STATS];
+static threading::PthreadFastMutex perf_lock;
+
+// 0: not opened yet on this thread, 1: open, -1: unavailable
+static __thread int perf_state;
+static __thread int perf_fds[PerfCounters::NUM_EVENTS];
+static __thread uint64_t perf_last[PerfCounters::NUM_EVENTS];
+
+PerfCounters::StatCounters* PerfCounters::getStatCounters(uint64_t* timer_counter) {
+    int idx = timer_counter - Stats::slots;
+    assert(idx >= 0 && idx < Stats::MAX_STATS);
+
+    StatCounters* rtn = perf_stat_counters[idx].load(std::memory_order_acquire);
+    if (likely(rtn))
+        return rtn;
+
+    LOCK_REGION(&perf_lock);
+    rtn = perf_stat_counters[idx].load(std::memory_order_relaxed);
+    if (rtn)
+        return rtn;
+
+    std::string name;
+    {
+        LOCK_REGION(&stats_lock);
+        name = (*Stats::names)[timer_counter];
+    }
+    if (startswith(name, "us_"))
+        name = name.substr(3);
+
+    static const char* const suffixes[] = { "_instructions", "_cycles", "_llc_misses", "_branch_misses" };
+    static_assert(sizeof(suffixes) / sizeof(suffixes[0]) == NUM_EVENTS, "");
+    rtn = new StatCounters();
+    for (int i = 0; i < NUM_EVENTS; i++)
+        rtn->events[i] = Stats::getStatCounter("perf_" + name + suffixes[i]);
+    perf_stat_counters[idx].store(rtn, std::memory_order_release);
+    return rtn;
+}
+
+static bool readPerfCounters(uint64_t* values) {
+    // With PERF_FORMAT_GROUP, reading the leader returns the number of events followed by all of their values.
+    uint64_t buf[1 + PerfCounters::NUM_EVENTS];
+    if (read(perf_fds[0], buf, sizeof(buf)) != sizeof(buf))
+        return false;
+    memcpy(values, buf + 1, sizeof(uint64_t) * PerfCounters::NUM_EVENTS);
+    return true;
+}
+
+static void perfAtForkChild() {
+    // The inherited counters keep measuring the thread in the parent; this thread has to open its own.
+    PerfCounters::closeThread();
+}
+
+static bool openPerfCounters() {
+    static const uint64_t configs[] = { PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+                                        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+    static_assert(sizeof(configs) / sizeof(configs[0]) == PerfCounters::NUM_EVENTS, "");
+
+    static bool registered_atfork = false;
+    if (!registered_atfork) {
+        pthread_atfork(NULL, NULL, perfAtForkChild);
+        registered_atfork = true;
+    }
+
+    for (int i = 0; i < PerfCounters::NUM_EVENTS; i++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        // pid 0 and cpu -1: this thread, on whichever cpu it runs.  The group gets scheduled onto the PMU as a
+        // whole, so the ratios between the events stay meaningful even if the kernel has to multiplex counters.
+        int fd = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : perf_fds[0], 0);
+        if (fd == -1) {
+            static bool warned = false;
+            if (!warned) {
+                fprintf(stderr, "Warning: couldn't open the perf_event counters for the stat timers: %s\n",
+                        strerror(errno));
+                warned = true;
+            }
+            for (int j = 0; j < i; j++)
+                close(perf_fds[j]);
+            perf_state = -1;
+            return false;
+        }
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        perf_fds[i] = fd;
+    }
+
+    perf_state = 1;
+    if (!readPerfCounters(perf_last)) {
+        PerfCounters::closeThread();
+        perf_state = -1;
+        return false;
+    }
+    return true;
+}
+
+void PerfCounters::attributeTo(uint64_t* timer_counter) {
+    if (unlikely(perf_state != 1)) {
+        // There was no previous reading, so there is nothing to attribute yet.
+        if (perf_state == 0)
+            openPerfCounters();
+        return;
+    }
+
+    uint64_t now[NUM_EVENTS];
+    if (!readPerfCounters(now))
+        return;
+
+    StatCounters* counters = getStatCounters(timer_counter);
+    for (int i = 0; i < NUM_EVENTS; i++) {
+        Stats::log(counters->events[i], now[i] - perf_last[i]);
+        perf_last[i] = now[i];
+    }
+}
+
+void PerfCounters::restart() {
+    if (perf_state == 1)
+        readPerfCounters(perf_last);
+    else if (perf_state == 0)
+        openPerfCounters();
+}
+
+void PerfCounters::closeThread() {
+    if (perf_state == 1) {
+        for (int i = 0; i < NUM_EVENTS; i++)
+            close(perf_fds[i]);
+    }
+    perf_state = 0;
+}
+#endif
+
 #endif
 }
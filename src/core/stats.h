@@ -16,6 +16,7 @@
 #define PYSTON_CORE_STATS_H
 
 #include <atomic>
+#include <cerrno>
 #include <cstdio>
 #include <string>
 #include <unordered_map>
@@ -39,6 +40,8 @@ namespace pyston {
 #define STAT_ICS_LOCATION (0 && STAT_ICS)
 #define STAT_TIMERS (0 && !DISABLE_STATS)
 #define EXPENSIVE_STAT_TIMERS (0 && STAT_TIMERS)
+// Also count hardware events for every stat timer (see PerfCounters):
+#define STAT_PERF_COUNTERS (0 && STAT_TIMERS)
 
 #if STAT_TIMERS
 #define STAT_TIMER(id, name, avoidability)                                                                             \
@@ -57,7 +60,20 @@ namespace pyston {
 #if !DISABLE_STATS
 // The class that stores and manages stats collection.  For normal stats collections purposes,
 // you shouldn't have to use this class, and will usually want to use StatCounter instead.
+//
+// The uint64_t* that getStatCounter() returns is only a handle: every thread increments its own shard of the
+// counters (allocated lazily, in chunks), and the shards get summed up whenever someone reads the stats.  This keeps
+// the increments cheap and unsynchronized while still giving correct totals with multiple threads.  The slot the
+// handle points to accumulates the shards of threads that exited.
 struct Stats {
+#if STAT_PERF_COUNTERS
+    friend class PerfCounters;
+#endif
+
+public:
+    static const int MAX_STATS = 1 << 16;
+    static const int CHUNK_SIZE = 1024;
+
 private:
     static std::unordered_map<uint64_t*, std::string>* names;
     static bool enabled;
@@ -65,6 +81,11 @@ private:
     static timespec start_ts;
     static uint64_t start_tick;
 
+    static uint64_t slots[MAX_STATS];
+    static __thread std::atomic<uint64_t>** thread_chunks;
+    static std::atomic<uint64_t>* getChunkSlowpath(int chunk_idx);
+    static uint64_t getTotal(int idx);
+
 public:
     static void startEstimatingCPUFreq();
     static double estimateCPUFreq();
@@ -72,13 +93,57 @@ public:
     static uint64_t* getStatCounter(const std::string& name);
 
     static void setEnabled(bool enabled) { Stats::enabled = enabled; }
-    static void log(uint64_t* counter, uint64_t count = 1) { *counter += count; }
+    static void log(uint64_t* counter, uint64_t count = 1) {
+        int idx = counter - slots;
+        assert(idx >= 0 && idx < MAX_STATS);
+
+        std::atomic<uint64_t>* chunk = thread_chunks ? thread_chunks[idx / CHUNK_SIZE] : NULL;
+        if (unlikely(!chunk))
+            chunk = getChunkSlowpath(idx / CHUNK_SIZE);
+
+        // Only this thread writes to its shard, so there is no need for an atomic add; the atomic type just makes
+        // the concurrent reads well-defined.
+        std::atomic<uint64_t>& c = chunk[idx % CHUNK_SIZE];
+        c.store(c.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+
+    // Returns the value of every counter (summed over all threads, and relative to the last clear()), sorted by name.
+    // If ticks_to_us is set, the timer counters (the ones whose name starts with "us_" or "_init_us_") get converted
+    // from CPU ticks to microseconds.
+    static std::vector<std::pair<std::string, uint64_t>> snapshot(bool ticks_to_us);
+
+    // Writes a snapshot to the given file in the binary format described by StatsExportHeader, so that an external
+    // agent can mmap it and read the stats without having to talk to this process.  Calling it again with the same
+    // path updates the file in place.  Returns false (with errno set) on failure.
+    static bool exportTo(const std::string& path);
+
+    // Folds the current thread's shard into the global totals; called when a thread exits.
+    static void unregisterThread();
 
     static void clear();
     static void dump(bool includeZeros = true);
     static void endOfInit();
 };
 
+// The layout of the file written by Stats::exportTo(): a header followed by num_entries StatsExportEntry's.  The
+// file is updated in place under a seqlock: seq is odd while an update is in progress, so readers should read seq,
+// copy the data, and retry if seq was odd or has changed in the meantime.  The file can grow between updates; readers
+// should re-map it if num_entries doesn't fit in their mapping.
+struct StatsExportHeader {
+    char magic[8]; // "PYSTATS\0"
+    uint32_t version;
+    std::atomic<uint32_t> seq;
+    uint32_t num_entries;
+    uint32_t entry_size; // sizeof(StatsExportEntry)
+    uint64_t pid;
+    uint64_t timestamp_ns; // CLOCK_REALTIME of the last update
+};
+
+struct StatsExportEntry {
+    uint64_t value;  // timers are in microseconds
+    char name[120];  // NUL-terminated, and truncated if necessary
+};
+
 // A helper class for efficient stats collections.  Typical usage:
 //
 //     static StatCounter my_stat_counter("my_informative_stat_name");
@@ -102,7 +167,7 @@ private:
 public:
     StatCounter(const std::string& name);
 
-    void log(uint64_t count = 1) { *counter += count; }
+    void log(uint64_t count = 1) { Stats::log(counter, count); }
 };
 
 // Similar to StatCounter, but should be allocated as:
@@ -117,7 +182,7 @@ private:
 public:
     StatPerThreadCounter(const std::string& name);
 
-    void log(uint64_t count = 1) { *counter += count; }
+    void log(uint64_t count = 1) { Stats::log(counter, count); }
 };
 
 #else
@@ -129,6 +194,12 @@ struct Stats {
     static void clear() {}
     static void log(uint64_t* counter, int count = 1) {}
     static uint64_t* getStatCounter(const std::string& name) { return nullptr; }
+    static std::vector<std::pair<std::string, uint64_t>> snapshot(bool ticks_to_us) { return {}; }
+    static bool exportTo(const std::string& path) {
+        errno = ENOSYS;
+        return false;
+    }
+    static void unregisterThread() {}
     static void endOfInit() {}
 };
 struct StatCounter {
@@ -143,6 +214,43 @@ struct StatPerThreadCounter {
 
 #if STAT_TIMERS
 
+#if STAT_PERF_COUNTERS
+// Hardware performance counters for the stat timers, so that we can tell whether a phase (the interpreter, the
+// baseline jit, jitted code, IC rewriting, unwinding...) is slow because it executes a lot of instructions, or because
+// it is stalled on cache misses or branch mispredicts.
+//
+// Every thread opens its own group of perf_event counters (user-space only) the first time it needs them.  Whenever
+// a timer gets paused, the events since the previous transition get attributed to it, in the stats
+// "perf_<timer>_instructions", "perf_<timer>_cycles", "perf_<timer>_llc_misses" and "perf_<timer>_branch_misses"
+// (with the "us_" prefix of the timer name dropped); Stats::dump() prints the IPC and misses per 1k instructions.
+//
+// Each transition costs a read() of the counter group, on top of the usual stat timer overhead, so the timers with a
+// very high call count get skewed.  If the counters can't be opened (no hardware PMU, or perf_event_paranoid too
+// high), this prints a warning once and the timers work as before.
+class PerfCounters {
+public:
+    enum Event {
+        INSTRUCTIONS,
+        CYCLES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        NUM_EVENTS,
+    };
+
+    // Attributes the events that happened on this thread since the last call to the given timer counter.
+    static void attributeTo(uint64_t* timer_counter);
+    // Starts a new segment, without attributing the events since the last call to anything.
+    static void restart();
+    static void closeThread();
+
+    // The stat counters that the events of a timer get logged to.
+    struct StatCounters;
+
+private:
+    static StatCounters* getStatCounters(uint64_t* timer_counter);
+};
+#endif
+
 // StatTimers are for a specific type of profiling investigation.  Until we make this more usable,
 // there probably shouldn't be more changes or uses of this class.
 class StatTimer {
@@ -213,6 +321,9 @@ public:
         assert(!stack);
         _prev = stack;
         stack = this;
+#if STAT_PERF_COUNTERS
+        PerfCounters::restart();
+#endif
         resume(at_time);
     }
 
@@ -228,10 +339,11 @@ private:
         assert(at_time > _start_time);
 
         uint64_t _duration = at_time - _start_time;
-        if (counter_override)
-            Stats::log(counter_override, _duration);
-        else
-            Stats::log(_statcounter, _duration);
+        uint64_t* counter = counter_override ? counter_override : _statcounter;
+        Stats::log(counter, _duration);
+#if STAT_PERF_COUNTERS
+        PerfCounters::attributeTo(counter);
+#endif
 
         _start_time = 0;
     }
@@ -25,6 +25,7 @@
 #include "Python.h"
 
 #include "codegen/codegen.h" // sigprof_pending
+#include "codegen/profiling/sampling_profiler.h"
 #include "core/common.h"
 #include "core/options.h"
 #include "core/stats.h"
@@ -145,6 +146,8 @@ static void registerThread(bool is_starting_thread) {
     if (is_starting_thread)
         num_starting_threads--;
 
+    registerSamplingProfilerThread();
+
     if (VERBOSITY() >= 2)
         printf("child initialized; tid=%ld\n", current_thread);
 }
@@ -188,6 +191,9 @@ static void unregisterThread() {
     PyThreadState_Clear(current_internal_thread_state->public_thread_state);
     assert(current_internal_thread_state->holdsGil());
 
+    unregisterSamplingProfilerThread();
+    Stats::unregisterThread();
+
     {
         pthread_t current_thread = pthread_self();
         LOCK_REGION(&threading_lock);
@@ -311,6 +317,7 @@ void registerMainThread() {
     assert(!current_internal_thread_state);
     current_internal_thread_state = new ThreadStateInternal(pthread_self(), &cur_thread_state);
     current_threads[pthread_self()] = current_internal_thread_state;
+    registerSamplingProfilerThread();
 
     endAllowThreads();
 }
@@ -515,7 +522,7 @@ static char pendingbusy = 0;
 // When these conditions become true, we can unconditionally set _stop_thread=1,
 // but when a condition becomes false, we have to check all the conditions:
 static void _recalcStopThread() {
-    _stop_thread = (_async_excs > 0 || (pendingfirst != pendinglast));
+    _stop_thread = (_async_excs > 0 || (pendingfirst != pendinglast) || sampling_profiler_drain_requested);
 }
 
 extern "C" int Py_AddPendingCall(int (*func)(void*), void* arg) noexcept {
@@ -584,6 +591,12 @@ extern "C" int Py_MakePendingCalls(void) noexcept {
         return -1;
     }
 
+    // Pyston addition: unlike the pending calls, the sampling profiler's rings can get drained by any thread.
+    if (sampling_profiler_drain_requested) {
+        drainSamplingProfilerIfRequested();
+        _recalcStopThread();
+    }
+
     /* only service pending calls on main thread */
     // Pyston change:
     // if (main_thread && PyThread_get_thread_ident() != main_thread)
@@ -714,6 +727,12 @@ extern "C" void PyThreadState_Clear(PyThreadState* tstate) noexcept {
     Py_CLEAR(tstate->curexc_traceback);
 
     Py_CLEAR(tstate->async_exc);
+
+    _Py_TracingPossible -= (tstate->c_profilefunc != NULL) + (tstate->c_tracefunc != NULL);
+    tstate->c_profilefunc = NULL;
+    tstate->c_tracefunc = NULL;
+    Py_CLEAR(tstate->c_profileobj);
+    Py_CLEAR(tstate->c_traceobj);
 }
 
 extern "C" PyThreadState* PyInterpreterState_ThreadHead(PyInterpreterState* interp) noexcept {
@@ -756,7 +775,7 @@ extern "C" void PyEval_RestoreThread(PyThreadState* tstate) noexcept {
 
 } // namespace threading
 
-__thread PyThreadState cur_thread_state
-    = { NULL, &threading::interpreter_state, NULL, 0, 1, NULL, NULL, NULL, NULL, 0, NULL, NULL, 0 };
+__thread PyThreadState cur_thread_state = { NULL, &threading::interpreter_state, NULL, 0, 1, NULL, NULL, NULL, NULL, 0,
+                                            NULL, NULL, 0, 0, 0, NULL, NULL, NULL, NULL };
 
 } // namespace pyston
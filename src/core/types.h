@@ -52,6 +52,15 @@ enum class EffortLevel {
     MAXIMAL = 3,
 };
 
+// Why a function (or part of one) got compiled; only used for the jit event log.
+enum class JitCompileReason {
+    TIERUP,              // it got executed often enough in the tier below
+    RESPECIALIZE,        // none of the existing versions accepted the argument types
+    SPECULATION_FAILURE, // the previous version got thrown away because its speculations kept failing
+    OSR,                 // a loop got hot enough to jump into compiled code in the middle of the function
+    REOPT,               // a version got called often enough to recompile it at a higher effort level
+};
+
 // Pyston supports two ways of implementing Python exceptions: by using return-code-based exceptions ("CAPI"
 // style since this is what the CPython C API uses), or our custom C++-based exceptions ("CXX" style).  CAPI
 // is faster when an exception is thrown, and CXX is faster when an exception is not thrown, so depending on
@@ -334,6 +343,10 @@ public:
 
     void addDependent(ICSlotInfo* icentry);
     int64_t version();
+    // Code that can't register itself as a dependent (ex guards in llvm-generated code) can instead compare the value
+    // at this address against the version() it was generated for: it changes every time the dependents get
+    // invalidated.
+    const int64_t* versionAddr() const { return &cur_version; }
     void invalidateAll();
     void remove(ICSlotInfo* icentry) { dependents.erase(icentry); }
 
@@ -428,8 +441,9 @@ public:
     // - all entries in ics (after deregistering them)
     ~CompiledFunction();
 
-    // Call this when a speculation inside this version failed
-    void speculationFailed();
+    // Call this when a speculation inside this version failed.  Returns whether the version got thrown away because of
+    // it.
+    bool speculationFailed();
 };
 
 typedef int FutureFlags;
@@ -518,8 +532,8 @@ struct CallRewriteArgs;
 // Compiles a new version of the function with the given signature and adds it to the list;
 // should only be called after checking to see if the other versions would work.
 CompiledFunction* compileFunction(BoxedCode* code, FunctionSpecialization* spec, EffortLevel effort,
-                                  const OSREntryDescriptor* entry, bool force_exception_style = false,
-                                  ExceptionStyle forced_exception_style = CXX);
+                                  const OSREntryDescriptor* entry, JitCompileReason reason,
+                                  bool force_exception_style = false, ExceptionStyle forced_exception_style = CXX);
 EffortLevel initialEffort();
 
 #if BOOLS_AS_I64
@@ -965,7 +979,7 @@ static_assert(offsetof(BoxVar, ob_size) == offsetof(struct _varobject, ob_size),
         assert(default_cls->is_pyston_class);                                                                          \
         assert(default_cls->attrs_offset == 0);                                                                        \
                                                                                                                        \
-        void* mem = PyObject_MALLOC(size + nitems * itemsize);                                                         \
+        void* mem = _PyObject_MallocFast(size + nitems * itemsize);                                                    \
         assert(mem);                                                                                                   \
                                                                                                                        \
         BoxVar* rtn = static_cast<BoxVar*>(mem);                                                                       \
@@ -1022,6 +1036,12 @@ struct ExcInfo {
 class BoxedFrame;
 
 // Our internal data structure for storing certain information about a stack frame.
+enum class FrameTier : int {
+    INTERPRETER = 0,
+    BASELINE_JIT = 1,
+    LLVM = 2,
+};
+
 struct FrameInfo {
     // Note(kmod): we have a number of fields here that all have independent
     // initialization rules.  We could potentially save time on every function-entry
@@ -1059,6 +1079,9 @@ struct FrameInfo {
     // TODO does this need to be owned?  how does cpython do it?
     BORROWED(BoxedCode*) code;
 
+    // Which tier is currently executing this frame.  Purely informational; read by the sampling profiler.
+    FrameTier tier;
+
     BORROWED(Box*) updateBoxedLocals();
 
     static FrameInfo* const NO_DEINIT;
@@ -1078,7 +1101,8 @@ struct FrameInfo {
           stmt_offset(-1),
           globals(0),
           back(0),
-          code(0) {}
+          code(0),
+          tier(FrameTier::INTERPRETER) {}
 };
 
 // callattr() takes a number of flags and arguments, and for performance we pack them into a single register:
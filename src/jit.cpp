@@ -38,6 +38,7 @@
 #include "codegen/entry.h"
 #include "codegen/irgen/hooks.h"
 #include "codegen/parser.h"
+#include "codegen/profiling/jit_events.h"
 #include "core/ast.h"
 #include "core/common.h"
 #include "core/options.h"
@@ -205,6 +206,8 @@ int handleArg(char code) {
         LOG_IC_ASSEMBLY = true;
     } else if (code == 'p') {
         PROFILE = true;
+    } else if (code == 'J') {
+        PERF_JITDUMP = true;
     } else if (code == 'j') {
         DUMPJIT = true;
     } else if (code == 'T') {
@@ -331,7 +334,7 @@ static int main(int argc, char** argv) noexcept {
 
         // Suppress getopt errors so we can throw them ourselves
         opterr = 0;
-        while ((code = getopt(argc, argv, "+:OLqdIibpjtrTRSUvnxXEBac:FuPTGm:")) != -1) {
+        while ((code = getopt(argc, argv, "+:OLqdIibpJjtrTRSUvnxXEBac:FuPTGm:")) != -1) {
             if (code == 'c') {
                 assert(optarg);
                 command = optarg;
@@ -366,6 +369,11 @@ static int main(int argc, char** argv) noexcept {
         _PyRandom_Init();
         Stats::startEstimatingCPUFreq();
 
+        if ((p = getenv("PYSTON_JIT_EVENT_LOG")) && *p != '\0') {
+            if (!setJitEventLogFile(p))
+                fprintf(stderr, "Warning: could not open jit event log %s: %s\n", p, strerror(errno));
+        }
+
         const char* fn = NULL;
 
         threading::registerMainThread();
@@ -12,7 +12,12 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "asm_writing/icinfo.h"
 #include "codegen/parser.h"
+#include "codegen/profiling/alloc_profiler.h"
+#include "codegen/profiling/deopt_trace.h"
+#include "codegen/profiling/jit_events.h"
+#include "codegen/profiling/sampling_profiler.h"
 #include "core/types.h"
 #include "runtime/objmodel.h"
 #include "runtime/types.h"
@@ -64,6 +69,183 @@ static Box* dumpStats(Box* includeZeros) {
     Py_RETURN_NONE;
 }
 
+static Box* getStats() {
+    BoxedDict* rtn = new BoxedDict();
+    AUTO_DECREF(rtn);
+    for (const auto& p : Stats::snapshot(/* ticks_to_us */ true)) {
+        PyDict_SetItem(rtn, autoDecref(boxString(p.first)), autoDecref(PyInt_FromSize_t(p.second)));
+    }
+    return incref(rtn);
+}
+
+static Box* exportStats(Box* path) {
+    if (path->cls != str_cls)
+        raiseExcHelper(TypeError, "path must be a 'string' object but received a '%s'", getTypeName(path));
+    if (!Stats::exportTo(static_cast<BoxedString*>(path)->s().str())) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, static_cast<BoxedString*>(path)->data());
+        throwCAPIException();
+    }
+    Py_RETURN_NONE;
+}
+
+static void setItem(BoxedDict* d, const char* key, Box* value) {
+    AUTO_DECREF(value);
+    PyDict_SetItemString(d, key, value);
+}
+
+static Box* getICs() {
+    BoxedList* rtn = new BoxedList();
+    AUTO_DECREF(rtn);
+
+    for (ICInfo* ic : getAllICInfos()) {
+        BoxedDict* d = new BoxedDict();
+        AUTO_DECREF(d);
+
+        BoxedCode* code = ic->getCode();
+        setItem(d, "filename", code && code->filename ? incref(code->filename) : incref(Py_None));
+        setItem(d, "name", code && code->name ? incref(code->name) : incref(Py_None));
+        setItem(d, "lineno", code && ic->getLineno() != -1 ? boxInt(ic->getLineno()) : incref(Py_None));
+        setItem(d, "kind", ic->lastDebugName() ? boxString(ic->lastDebugName()) : incref(Py_None));
+
+        int num_slots = 0, num_used = 0;
+        std::vector<std::string> guarded_classes;
+        for (const ICSlotInfo& slot : ic->getSlots()) {
+            num_slots++;
+            if (!slot.used)
+                continue;
+            num_used++;
+            for (const std::string& name : slot.guarded_classes) {
+                if (std::find(guarded_classes.begin(), guarded_classes.end(), name) == guarded_classes.end())
+                    guarded_classes.push_back(name);
+            }
+        }
+        setItem(d, "slots", boxInt(num_slots));
+        setItem(d, "slots_used", boxInt(num_used));
+
+        BoxedList* guarded_classes_list = new BoxedList();
+        for (const std::string& name : guarded_classes)
+            listAppendInternalStolen(guarded_classes_list, boxString(name));
+        setItem(d, "guarded_classes", guarded_classes_list);
+
+        setItem(d, "times_rewritten", boxInt(ic->timesRewritten()));
+        setItem(d, "times_slowpath", boxInt(ic->timesSlowpath()));
+        setItem(d, "times_aborted", boxInt(ic->timesAborted()));
+        setItem(d, "percent_megamorphic", boxInt(std::min(ic->percentMegamorphic(), 100)));
+        setItem(d, "megamorphic", boxBool(ic->isMegamorphic()));
+        setItem(d, "retry_in", boxInt(ic->retryIn()));
+        setItem(d, "retry_backoff", boxInt(ic->percentBackedoff()));
+
+        listAppendInternal(rtn, d);
+    }
+    return incref(rtn);
+}
+
+static Box* getJitEvents(Box* clear) {
+    if (clear->cls != bool_cls)
+        raiseExcHelper(TypeError, "clear must be a 'bool' object but received a '%s'", getTypeName(clear));
+
+    BoxedList* rtn = new BoxedList();
+    AUTO_DECREF(rtn);
+    for (const JitCompileEvent& e : getJitCompileEvents(clear == Py_True)) {
+        BoxedDict* d = new BoxedDict();
+        AUTO_DECREF(d);
+        setItem(d, "time", boxFloat(e.time));
+        setItem(d, "tier", boxString(tierName(e.tier)));
+        setItem(d, "effort", boxInt(e.effort));
+        setItem(d, "reason", boxString(jitCompileReasonName(e.reason)));
+        setItem(d, "name", boxString(e.name));
+        setItem(d, "filename", boxString(e.filename));
+        setItem(d, "firstlineno", boxInt(e.firstlineno));
+        setItem(d, "block", e.block_idx != -1 ? boxInt(e.block_idx) : incref(Py_None));
+        setItem(d, "ir_size", boxInt(e.ir_size));
+        setItem(d, "compile_us", boxInt(e.compile_us));
+        setItem(d, "code_size", boxInt(e.code_size));
+        setItem(d, "object_cache_hit", boxBool(e.object_cache_hit));
+        listAppendInternal(rtn, d);
+    }
+    return incref(rtn);
+}
+
+static Box* getJitTotals() {
+    BoxedDict* rtn = new BoxedDict();
+    AUTO_DECREF(rtn);
+    for (FrameTier tier : { FrameTier::BASELINE_JIT, FrameTier::LLVM }) {
+        const JitCompileTotals& t = getJitCompileTotals(tier);
+        BoxedDict* d = new BoxedDict();
+        setItem(d, "num_compiles", boxInt(t.num_compiles));
+        setItem(d, "compile_us", boxInt(t.compile_us));
+        setItem(d, "code_size", boxInt(t.code_size));
+        setItem(rtn, tierName(tier), d);
+    }
+    return incref(rtn);
+}
+
+static Box* setJitEventLog(Box* path) {
+    if (path != Py_None && path->cls != str_cls)
+        raiseExcHelper(TypeError, "path must be a 'string' object or None but received a '%s'", getTypeName(path));
+    const char* c_path = path == Py_None ? NULL : static_cast<BoxedString*>(path)->data();
+    if (!setJitEventLogFile(c_path)) {
+        PyErr_SetFromErrnoWithFilename(PyExc_IOError, c_path);
+        throwCAPIException();
+    }
+    Py_RETURN_NONE;
+}
+
+static Box* getDeopts(Box* clear) {
+    if (clear->cls != bool_cls)
+        raiseExcHelper(TypeError, "clear must be a 'bool' object but received a '%s'", getTypeName(clear));
+
+    BoxedList* rtn = new BoxedList();
+    AUTO_DECREF(rtn);
+    for (const DeoptEvent& e : getDeoptEvents(clear == Py_True)) {
+        BoxedDict* d = new BoxedDict();
+        AUTO_DECREF(d);
+        setItem(d, "time", boxFloat(e.time));
+        setItem(d, "kind", boxString(e.kind == DeoptKind::DEOPT ? "deopt" : "osr"));
+        setItem(d, "name", boxString(e.name));
+        setItem(d, "filename", boxString(e.filename));
+        setItem(d, "lineno", boxInt(e.lineno));
+        setItem(d, "node", boxString(e.node));
+        if (e.kind == DeoptKind::DEOPT) {
+            setItem(d, "expected", boxString(e.expected_cls));
+            setItem(d, "actual", boxString(e.actual_cls));
+        } else {
+            setItem(d, "expected", incref(Py_None));
+            setItem(d, "actual", incref(Py_None));
+        }
+        setItem(d, "from_tier", boxString(tierName(e.from_tier)));
+        setItem(d, "to_tier", boxString(tierName(e.to_tier)));
+        setItem(d, "effort", boxInt(e.effort));
+        setItem(d, "invalidated", boxBool(e.version_invalidated));
+        listAppendInternal(rtn, d);
+    }
+    return incref(rtn);
+}
+
+static Box* getDeoptSitesPy(Box* clear) {
+    if (clear->cls != bool_cls)
+        raiseExcHelper(TypeError, "clear must be a 'bool' object but received a '%s'", getTypeName(clear));
+
+    BoxedList* rtn = new BoxedList();
+    AUTO_DECREF(rtn);
+    for (const DeoptSite& site : getDeoptSites(clear == Py_True)) {
+        BoxedDict* d = new BoxedDict();
+        AUTO_DECREF(d);
+        setItem(d, "name", boxString(site.name));
+        setItem(d, "filename", boxString(site.filename));
+        setItem(d, "lineno", boxInt(site.lineno));
+        setItem(d, "node", boxString(site.node));
+        setItem(d, "expected", boxString(site.expected_cls));
+        setItem(d, "count", boxInt(site.count));
+        BoxedDict* actual = new BoxedDict();
+        for (auto&& p : site.actual_classes)
+            setItem(actual, p.first.c_str(), boxInt(p.second));
+        setItem(d, "actual", actual);
+        listAppendInternal(rtn, d);
+    }
+    return incref(rtn);
+}
+
 static Box* pyCompile(Box* fname, Box* force) {
     if (fname->cls != str_cls)
         raiseExcHelper(TypeError, "py_compile takes a string for the filename");
@@ -76,6 +258,96 @@ static Box* pyCompile(Box* fname, Box* force) {
     Py_RETURN_NONE;
 }
 
+// Meant to be called before fork()ing workers: makes everything that is alive at this point immortal and takes it out
+// of the cycle collector, so that the workers don't write to (and thereby un-share) those pages.
+static Box* freeze() {
+    PyGC_Collect();
+    return boxInt(_PyGC_Freeze());
+}
+
+static Box* startProfiler(Box* interval_us) {
+    if (interval_us->cls != int_cls)
+        raiseExcHelper(TypeError, "interval_us must be a 'int' object but received a '%s'", getTypeName(interval_us));
+    int64_t n = ((BoxedInt*)interval_us)->n;
+    if (n <= 0 || n > INT_MAX)
+        raiseExcHelper(ValueError, "interval_us out of range");
+
+    startSamplingProfiler(n);
+    Py_RETURN_NONE;
+}
+
+static Box* stopProfiler() {
+    stopSamplingProfiler();
+    Py_RETURN_NONE;
+}
+
+static Box* getProfile(Box* clear) {
+    if (clear->cls != bool_cls)
+        raiseExcHelper(TypeError, "clear must be a 'bool' object but received a '%s'", getTypeName(clear));
+    return boxString(getSamplingProfile(clear == Py_True));
+}
+
+static Box* startAllocProfiler(Box* interval_bytes) {
+    if (interval_bytes->cls != int_cls)
+        raiseExcHelper(TypeError, "interval_bytes must be a 'int' object but received a '%s'",
+                       getTypeName(interval_bytes));
+    int64_t n = ((BoxedInt*)interval_bytes)->n;
+    if (n <= 0)
+        raiseExcHelper(ValueError, "interval_bytes out of range");
+
+    startAllocationProfiler(n);
+    Py_RETURN_NONE;
+}
+
+static Box* stopAllocProfiler() {
+    stopAllocationProfiler();
+    Py_RETURN_NONE;
+}
+
+static Box* allocationsToList(const std::vector<AllocationProfileEntry>& entries) {
+    BoxedList* rtn = new BoxedList();
+    AUTO_DECREF(rtn);
+    for (const AllocationProfileEntry& e : entries) {
+        BoxedDict* d = new BoxedDict();
+        AUTO_DECREF(d);
+        setItem(d, "type", boxString(e.type));
+        setItem(d, "stack", boxString(e.stack));
+        setItem(d, "samples", boxInt(e.samples));
+        setItem(d, "count", boxFloat(e.count));
+        setItem(d, "bytes", boxFloat(e.bytes));
+        listAppendInternal(rtn, d);
+    }
+    return incref(rtn);
+}
+
+static Box* getAllocProfile(Box* clear) {
+    if (clear->cls != bool_cls)
+        raiseExcHelper(TypeError, "clear must be a 'bool' object but received a '%s'", getTypeName(clear));
+    return allocationsToList(getAllocationProfile(clear == Py_True));
+}
+
+static Box* getLiveAllocs() {
+    return allocationsToList(getLiveAllocations());
+}
+
+// Returns a list of (block size, inline allocations, out-of-line allocations) for every pymalloc size class that has
+// been allocated from.
+static Box* getAllocSizeClasses() {
+    BoxedList* rtn = new BoxedList();
+    AUTO_DECREF(rtn);
+#ifdef WITH_PYMALLOC
+    for (int i = 0; i < _PYMALLOC_NB_SIZE_CLASSES; i++) {
+        if (!_PyObject_SizeClassFast[i] && !_PyObject_SizeClassSlow[i])
+            continue;
+        int block_size = (i + 1) << _PYMALLOC_ALIGNMENT_SHIFT;
+        listAppendInternal(rtn, autoDecref(BoxedTuple::create({ autoDecref(boxInt(block_size)),
+                                                                autoDecref(boxInt(_PyObject_SizeClassFast[i])),
+                                                                autoDecref(boxInt(_PyObject_SizeClassSlow[i])) })));
+    }
+#endif
+    return incref(rtn);
+}
+
 void setupPyston() {
     pyston_module = createModule(autoDecref(boxString("__pyston__")));
 
@@ -87,8 +359,60 @@ void setupPyston() {
     pyston_module->giveAttr("dumpStats",
                             new BoxedBuiltinFunctionOrMethod(
                                 BoxedCode::create((void*)dumpStats, NONE, 1, false, false, "dumpStats"), { Py_False }));
+    pyston_module->giveAttr(
+        "getStats", new BoxedBuiltinFunctionOrMethod(BoxedCode::create((void*)getStats, DICT, 0, "getStats")));
+    pyston_module->giveAttr("exportStats", new BoxedBuiltinFunctionOrMethod(
+                                               BoxedCode::create((void*)exportStats, NONE, 1, "exportStats")));
 
     pyston_module->giveAttr(
         "py_compile", new BoxedBuiltinFunctionOrMethod(BoxedCode::create((void*)pyCompile, UNKNOWN, 2, "pyCompile")));
+
+    pyston_module->giveAttr("startProfiler", new BoxedBuiltinFunctionOrMethod(
+                                                 BoxedCode::create((void*)startProfiler, NONE, 1, false, false,
+                                                                   "startProfiler"),
+                                                 { autoDecref(boxInt(10000)) }));
+    pyston_module->giveAttr("stopProfiler", new BoxedBuiltinFunctionOrMethod(
+                                                BoxedCode::create((void*)stopProfiler, NONE, 0, "stopProfiler")));
+    pyston_module->giveAttr("getProfile",
+                            new BoxedBuiltinFunctionOrMethod(
+                                BoxedCode::create((void*)getProfile, STR, 1, false, false, "getProfile"), { Py_False }));
+
+    pyston_module->giveAttr("startAllocProfiler", new BoxedBuiltinFunctionOrMethod(
+                                                      BoxedCode::create((void*)startAllocProfiler, NONE, 1, false,
+                                                                        false, "startAllocProfiler"),
+                                                      { autoDecref(boxInt(512 * 1024)) }));
+    pyston_module->giveAttr("stopAllocProfiler", new BoxedBuiltinFunctionOrMethod(BoxedCode::create(
+                                                     (void*)stopAllocProfiler, NONE, 0, "stopAllocProfiler")));
+    pyston_module->giveAttr("getAllocProfile", new BoxedBuiltinFunctionOrMethod(
+                                                   BoxedCode::create((void*)getAllocProfile, LIST, 1, false, false,
+                                                                     "getAllocProfile"),
+                                                   { Py_False }));
+    pyston_module->giveAttr("getLiveAllocs", new BoxedBuiltinFunctionOrMethod(BoxedCode::create(
+                                                 (void*)getLiveAllocs, LIST, 0, "getLiveAllocs")));
+    pyston_module->giveAttr("getAllocSizeClasses", new BoxedBuiltinFunctionOrMethod(BoxedCode::create(
+                                                       (void*)getAllocSizeClasses, LIST, 0, "getAllocSizeClasses")));
+
+    pyston_module->giveAttr("getICs",
+                            new BoxedBuiltinFunctionOrMethod(BoxedCode::create((void*)getICs, LIST, 0, "getICs")));
+
+    pyston_module->giveAttr("getJitEvents", new BoxedBuiltinFunctionOrMethod(
+                                                BoxedCode::create((void*)getJitEvents, LIST, 1, false, false,
+                                                                  "getJitEvents"),
+                                                { Py_False }));
+    pyston_module->giveAttr("getJitTotals", new BoxedBuiltinFunctionOrMethod(
+                                                BoxedCode::create((void*)getJitTotals, DICT, 0, "getJitTotals")));
+    pyston_module->giveAttr("setJitEventLog", new BoxedBuiltinFunctionOrMethod(BoxedCode::create(
+                                                  (void*)setJitEventLog, NONE, 1, "setJitEventLog")));
+
+    pyston_module->giveAttr("getDeopts",
+                            new BoxedBuiltinFunctionOrMethod(
+                                BoxedCode::create((void*)getDeopts, LIST, 1, false, false, "getDeopts"), { Py_False }));
+    pyston_module->giveAttr("getDeoptSites", new BoxedBuiltinFunctionOrMethod(
+                                                 BoxedCode::create((void*)getDeoptSitesPy, LIST, 1, false, false,
+                                                                   "getDeoptSites"),
+                                                 { Py_False }));
+
+    pyston_module->giveAttr("freeze",
+                            new BoxedBuiltinFunctionOrMethod(BoxedCode::create((void*)freeze, BOXED_INT, 0, "freeze")));
 }
 }
@@ -21,6 +21,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "Python.h"
+#include "frameobject.h"
 #include "structseq.h"
 
 #include "capi/types.h"
@@ -523,6 +524,156 @@ static PyObject* sys_gettotalrefcount(PyObject* self) {
 }
 #endif /* Py_REF_DEBUG */
 
+/*
+ * Cached interned string objects used for calling the profile and
+ * trace functions.  Initialized by trace_init().
+ */
+static PyObject* whatstrings[7] = { NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+static int trace_init(void) noexcept {
+    static const char* const whatnames[7]
+        = { "call", "exception", "line", "return", "c_call", "c_exception", "c_return" };
+    int i;
+    for (i = 0; i < 7; ++i) {
+        if (whatstrings[i] == NULL) {
+            whatstrings[i] = PyString_InternFromString(whatnames[i]);
+            if (whatstrings[i] == NULL)
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static PyObject* call_trampoline(PyThreadState* tstate, PyObject* callback, PyFrameObject* frame, int what,
+                                 PyObject* arg) noexcept {
+    PyObject* args = PyTuple_New(3);
+    PyObject* whatstr;
+    PyObject* result;
+
+    if (args == NULL)
+        return NULL;
+    Py_INCREF(frame);
+    whatstr = whatstrings[what];
+    Py_INCREF(whatstr);
+    if (arg == NULL)
+        arg = Py_None;
+    Py_INCREF(arg);
+    PyTuple_SET_ITEM(args, 0, (PyObject*)frame);
+    PyTuple_SET_ITEM(args, 1, whatstr);
+    PyTuple_SET_ITEM(args, 2, arg);
+
+    /* call the Python-level function */
+    // Pyston change: our frames don't have fast locals that would need to get synced
+    result = PyEval_CallObject(callback, args);
+
+    /* cleanup */
+    Py_DECREF(args);
+    return result;
+}
+
+static int profile_trampoline(PyObject* self, PyFrameObject* frame, int what, PyObject* arg) noexcept {
+    PyThreadState* tstate = PyThreadState_GET();
+    PyObject* result;
+
+    if (arg == NULL)
+        arg = Py_None;
+    result = call_trampoline(tstate, self, frame, what, arg);
+    if (result == NULL) {
+        PyEval_SetProfile(NULL, NULL);
+        return -1;
+    }
+    Py_DECREF(result);
+    return 0;
+}
+
+static int trace_trampoline(PyObject* self, PyFrameObject* frame, int what, PyObject* arg) noexcept {
+    PyThreadState* tstate = PyThreadState_GET();
+    PyObject* callback;
+    PyObject* result;
+
+    // Pyston change: f_trace is only reachable through PyFrame_GetTrace/PyFrame_SetTrace
+    if (what == PyTrace_CALL)
+        callback = self;
+    else
+        callback = PyFrame_GetTrace(frame);
+    if (callback == NULL)
+        return 0;
+    result = call_trampoline(tstate, callback, frame, what, arg);
+    if (result == NULL) {
+        PyEval_SetTrace(NULL, NULL);
+        PyFrame_SetTrace(frame, NULL);
+        return -1;
+    }
+    if (result != Py_None)
+        PyFrame_SetTrace(frame, result);
+    Py_DECREF(result);
+    return 0;
+}
+
+static PyObject* sys_settrace(PyObject* self, PyObject* args) noexcept {
+    if (trace_init() == -1)
+        return NULL;
+    if (args == Py_None)
+        PyEval_SetTrace(NULL, NULL);
+    else
+        PyEval_SetTrace(trace_trampoline, args);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* sys_gettrace(PyObject* self, PyObject* args) noexcept {
+    PyThreadState* tstate = PyThreadState_GET();
+    PyObject* temp = tstate->c_traceobj;
+
+    if (temp == NULL)
+        temp = Py_None;
+    Py_INCREF(temp);
+    return temp;
+}
+
+static PyObject* sys_setprofile(PyObject* self, PyObject* args) noexcept {
+    if (trace_init() == -1)
+        return NULL;
+    if (args == Py_None)
+        PyEval_SetProfile(NULL, NULL);
+    else
+        PyEval_SetProfile(profile_trampoline, args);
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+
+static PyObject* sys_getprofile(PyObject* self, PyObject* args) noexcept {
+    PyThreadState* tstate = PyThreadState_GET();
+    PyObject* temp = tstate->c_profileobj;
+
+    if (temp == NULL)
+        temp = Py_None;
+    Py_INCREF(temp);
+    return temp;
+}
+
+// Pyston change: we only generate 'call', 'return' and 'exception' events, so these don't mention the
+// per-line ones.
+PyDoc_STRVAR(settrace_doc, "settrace(function)\n\
+\n\
+Set the global debug tracing function.  It will be called on each\n\
+function call.  See the debugger chapter in the library manual.");
+
+PyDoc_STRVAR(gettrace_doc, "gettrace()\n\
+\n\
+Return the global debug tracing function set with sys.settrace.\n\
+See the debugger chapter in the library manual.");
+
+PyDoc_STRVAR(setprofile_doc, "setprofile(function)\n\
+\n\
+Set the profiling function.  It will be called on each function call\n\
+and return.  See the profiler chapter in the library manual.");
+
+PyDoc_STRVAR(getprofile_doc, "getprofile()\n\
+\n\
+Return the profiling function set with sys.setprofile.\n\
+See the profiler chapter in the library manual.");
+
 PyDoc_STRVAR(getrefcount_doc, "getrefcount(object) -> integer\n\
         \n\
         Return the reference count of object.  The count returned is generally\n\
@@ -547,6 +698,10 @@ static PyMethodDef sys_methods[] = {
     { "_clear_type_cache", sys_clear_type_cache, METH_NOARGS, sys_clear_type_cache__doc__ },
     { "getrefcount", (PyCFunction)sys_getrefcount, METH_O, getrefcount_doc },
     { "getsizeof", (PyCFunction)sys_getsizeof, METH_VARARGS | METH_KEYWORDS, getsizeof_doc },
+    { "settrace", sys_settrace, METH_O, settrace_doc },
+    { "gettrace", sys_gettrace, METH_NOARGS, gettrace_doc },
+    { "setprofile", sys_setprofile, METH_O, setprofile_doc },
+    { "getprofile", sys_getprofile, METH_NOARGS, getprofile_doc },
 };
 
 PyDoc_STRVAR(flags__doc__, "sys.flags\n\
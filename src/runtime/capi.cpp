@@ -1399,6 +1399,146 @@ Box* BoxedCApiFunction::__call__(BoxedCApiFunction* self, BoxedTuple* varargs, B
                                            NULL);
 }
 
+// Calls a METH_FASTCALL function whose arguments have already been collected into a tuple and (optionally) a dict.
+static Box* callFastCFunctionWithTuple(PyMethodDef* ml, Box* self, Box* varargs, Box* kwargs) noexcept {
+    assert(varargs->cls == tuple_cls);
+    BoxedTuple* t = static_cast<BoxedTuple*>(varargs);
+    int nargs = t->size();
+
+    if (!(ml->ml_flags & METH_KEYWORDS)) {
+        assert(!kwargs);
+        return ((_PyCFunctionFast)ml->ml_meth)(self, &t->elts[0], nargs);
+    }
+
+    if (!kwargs || PyDict_Size(kwargs) == 0)
+        return ((_PyCFunctionFastWithKeywords)ml->ml_meth)(self, &t->elts[0], nargs, NULL);
+
+    assert(kwargs->cls == dict_cls);
+    BoxedDict* d = static_cast<BoxedDict*>(kwargs);
+
+    std::vector<Box*> values(&t->elts[0], &t->elts[nargs]);
+    values.reserve(nargs + d->d.size());
+    BoxedTuple* kwnames = BoxedTuple::create(d->d.size());
+    AUTO_DECREF(kwnames);
+    int i = 0;
+    for (auto&& p : d->d) {
+        kwnames->elts[i++] = incref(p.first.value);
+        values.push_back(p.second);
+    }
+    return ((_PyCFunctionFastWithKeywords)ml->ml_meth)(self, values.data(), nargs, kwnames);
+}
+
+// METH_FASTCALL functions get their positional arguments as a C array rather than a tuple, and with METH_KEYWORDS
+// the keyword values follow them in the same array, with a tuple of their names alongside.  So a call with only
+// positional arguments can pass arg1/arg2/arg3/args through without allocating anything, and the IC for it is just
+// the call.
+//
+// The arguments start at index `skip` (method descriptors pass the object they are called on as arg1 and hand it
+// over as `self`).  The caller is responsible for guarding on `ml`.
+template <ExceptionStyle S>
+Box* callFastCFunction(PyMethodDef* ml, Box* self, RewriterVar* r_self, int skip, CallRewriteArgs* rewrite_args,
+                       ArgPassSpec argspec, Box* arg1, Box* arg2, Box* arg3, Box** args,
+                       const std::vector<BoxedString*>* keyword_names) {
+    int flags = ml->ml_flags & ~(METH_CLASS | METH_STATIC | METH_COEXIST);
+    assert(flags == METH_FASTCALL || flags == (METH_FASTCALL | METH_KEYWORDS));
+    bool takes_keywords = (flags & METH_KEYWORDS);
+
+    if (argspec.has_starargs || argspec.has_kwargs) {
+        // Let rearrangeArguments flatten the *args/**kwargs, and pass the contents of the result along.
+        auto continuation = [=](CallRewriteArgs* rewrite_args, Box* arg1, Box* arg2, Box* arg3, Box** args) {
+            Box* varargs = skip ? arg2 : arg1;
+            Box* kwargs = takes_keywords ? (skip ? arg3 : arg2) : NULL;
+            Box* rtn = callFastCFunctionWithTuple(ml, self, varargs, kwargs);
+            if (S == CXX && !rtn)
+                throwCAPIException();
+            return rtn;
+        };
+        return rearrangeArgumentsAndCall(ParamReceiveSpec(skip, 0, true, takes_keywords), NULL, ml->ml_name, NULL,
+                                         NULL, argspec, arg1, arg2, arg3, args, keyword_names, continuation);
+    }
+
+    if (argspec.num_keywords && !takes_keywords)
+        raiseExcHelper(TypeError, "%.200s() takes no keyword arguments", ml->ml_name);
+
+    int nargs = argspec.num_args - skip;
+    int nvalues = nargs + argspec.num_keywords;
+    assert(nargs >= 0);
+
+    Box* stack_values[8];
+    std::unique_ptr<Box* []> heap_values;
+    Box** values = stack_values;
+    if (nvalues > 8) {
+        heap_values.reset(new Box* [nvalues]);
+        values = heap_values.get();
+    }
+    for (int i = 0; i < nvalues; i++)
+        values[i] = getArg(i + skip, arg1, arg2, arg3, args);
+
+    BoxedTuple* kwnames = NULL;
+    if (argspec.num_keywords) {
+        kwnames = BoxedTuple::create(argspec.num_keywords);
+        for (int i = 0; i < argspec.num_keywords; i++)
+            kwnames->elts[i] = incref((*keyword_names)[i]);
+    }
+    AUTO_XDECREF(kwnames);
+
+    Box* rtn;
+    {
+        UNAVOIDABLE_STAT_TIMER(t0, "us_timer_in_builtins");
+        if (takes_keywords)
+            rtn = ((_PyCFunctionFastWithKeywords)ml->ml_meth)(self, values, nargs, kwnames);
+        else
+            rtn = ((_PyCFunctionFast)ml->ml_meth)(self, values, nargs);
+    }
+
+    // Keyword calls would need the names tuple baked into the IC; only rewrite the positional case, and only as
+    // many arguments as comfortably fit into the scratch space.
+    if (rewrite_args && !argspec.num_keywords && nargs <= 6) {
+        Rewriter* rewriter = rewrite_args->rewriter;
+
+        RewriterVar::SmallVector call_args;
+        RewriterVar::SmallVector uses;
+        call_args.push_back(r_self);
+        if (nargs == 0) {
+            call_args.push_back(rewriter->loadConst(0, Location::forArg(1)));
+        } else {
+            RewriterVar* r_values = rewriter->allocate(nargs);
+            for (int i = 0; i < nargs; i++) {
+                int idx = i + skip;
+                RewriterVar* r_arg;
+                if (idx == 0)
+                    r_arg = rewrite_args->arg1;
+                else if (idx == 1)
+                    r_arg = rewrite_args->arg2;
+                else if (idx == 2)
+                    r_arg = rewrite_args->arg3;
+                else
+                    r_arg = rewrite_args->args->getAttr(sizeof(Box*) * (idx - 3));
+                r_values->setAttr(sizeof(Box*) * i, r_arg, RewriterVar::SetattrType::REF_USED);
+                uses.push_back(r_arg);
+            }
+            call_args.push_back(r_values);
+        }
+        call_args.push_back(rewriter->loadConst(nargs, Location::forArg(2)));
+        if (takes_keywords)
+            call_args.push_back(rewriter->loadConst(0, Location::forArg(3)));
+
+        rewrite_args->out_rtn = rewriter->call(true, (void*)ml->ml_meth, call_args, {}, uses)->setType(RefType::OWNED);
+        if (S == CXX)
+            rewriter->checkAndThrowCAPIException(rewrite_args->out_rtn);
+        rewrite_args->out_success = true;
+    }
+
+    if (S == CXX && !rtn)
+        throwCAPIException();
+    return rtn;
+}
+
+template Box* callFastCFunction<CAPI>(PyMethodDef*, Box*, RewriterVar*, int, CallRewriteArgs*, ArgPassSpec, Box*, Box*,
+                                      Box*, Box**, const std::vector<BoxedString*>*);
+template Box* callFastCFunction<CXX>(PyMethodDef*, Box*, RewriterVar*, int, CallRewriteArgs*, ArgPassSpec, Box*, Box*,
+                                     Box*, Box**, const std::vector<BoxedString*>*);
+
 template <ExceptionStyle S>
 Box* BoxedCApiFunction::tppCall(Box* _self, CallRewriteArgs* rewrite_args, ArgPassSpec argspec, Box* arg1, Box* arg2,
                                 Box* arg3, Box** args,
@@ -1417,6 +1557,16 @@ Box* BoxedCApiFunction::tppCall(Box* _self, CallRewriteArgs* rewrite_args, ArgPa
 
     flags &= ~(METH_CLASS | METH_STATIC | METH_COEXIST);
 
+    if (flags & METH_FASTCALL) {
+        RewriterVar* r_passthrough = NULL;
+        if (rewrite_args)
+            r_passthrough = rewrite_args->rewriter->loadConst((intptr_t)self->passthrough, Location::forArg(0));
+        return callCXXFromStyle<S>([=]() {
+            return callFastCFunction<S>(self->method_def, self->passthrough, r_passthrough, 0, rewrite_args, argspec,
+                                        arg1, arg2, arg3, args, keyword_names);
+        });
+    }
+
     ParamReceiveSpec paramspec(0, 0, true, false);
     Box** defaults = NULL;
     if (flags == METH_VARARGS) {
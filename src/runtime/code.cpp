@@ -13,9 +13,11 @@
 // limitations under the License.
 //
 
+#include <algorithm>
 #include <sstream>
 
 #include "codegen/baseline_jit.h"
+#include "codegen/profiling/sampling_profiler.h"
 #include "runtime/objmodel.h"
 #include "runtime/set.h"
 
@@ -101,13 +103,26 @@ Box* BoxedCode::flags(Box* b, void*) noexcept {
     return boxInt(flags);
 }
 
+void BoxedCode::keepAliveForJit(Box* obj) {
+    if (std::find(jit_kept_alive.begin(), jit_kept_alive.end(), obj) != jit_kept_alive.end())
+        return;
+    jit_kept_alive.push_back(incref(obj));
+}
+
 void BoxedCode::dealloc(Box* b) noexcept {
     BoxedCode* o = static_cast<BoxedCode*>(b);
 
+    // Undrained samples might refer to us:
+    samplingProfilerBeforeCodeFree();
+
     Py_XDECREF(o->filename);
     Py_XDECREF(o->name);
     Py_XDECREF(o->_doc);
 
+    for (Box* obj : o->jit_kept_alive)
+        Py_DECREF(obj);
+    o->jit_kept_alive.clear();
+
     o->tryDeallocatingTheBJitCode();
     o->source.reset(nullptr);
     o->~BoxedCode();
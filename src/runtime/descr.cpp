@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "capi/typeobject.h"
+#include "capi/types.h"
 #include "codegen/compvars.h"
 #include "runtime/objmodel.h"
 #include "runtime/rewrite_args.h"
@@ -252,6 +253,40 @@ Box* methodDescrTppCall(Box* _self, CallRewriteArgs* rewrite_args, ArgPassSpec a
         rewrite_args->obj->addAttrGuard(offsetof(PyMethodDescrObject, d_method), (intptr_t)self->d_method);
     }
 
+    auto check_self = [=](Box* arg1) {
+        if (is_classmethod) {
+            if (!PyType_Check(arg1))
+                raiseExcHelper(TypeError, "descriptor '%s' requires a type but received a '%s'",
+                               self->d_method->ml_name, getFullTypeName(arg1).c_str());
+        } else {
+            if (!isSubclass(arg1->cls, self->d_type))
+                raiseExcHelper(TypeError, "descriptor '%s' requires a '%s' arg1 but received a '%s'",
+                               self->d_method->ml_name, self->d_type->tp_name, getFullTypeName(arg1).c_str());
+        }
+    };
+
+    if (call_flags & METH_FASTCALL) {
+        bool takes_keywords = (call_flags & METH_KEYWORDS);
+        if (argspec.num_args >= 1) {
+            check_self(arg1);
+            if (is_classmethod)
+                rewrite_args = NULL;
+            if (rewrite_args)
+                rewrite_args->arg1->addClsGuard(arg1->cls);
+            return callFastCFunction<CXX>(self->d_method, arg1, rewrite_args ? rewrite_args->arg1 : NULL, 1,
+                                          rewrite_args, argspec, arg1, arg2, arg3, args, keyword_names);
+        }
+
+        // The object we are called on is inside the *args (or passed by keyword); pull it out first.
+        auto continuation = [=](CallRewriteArgs* rewrite_args, Box* arg1, Box* arg2, Box* arg3, Box** args) {
+            check_self(arg1);
+            return callFastCFunction<CXX>(self->d_method, arg1, NULL, 0, NULL, ArgPassSpec(0, 0, true, takes_keywords),
+                                          arg2, takes_keywords ? arg3 : NULL, NULL, NULL, NULL);
+        };
+        return rearrangeArgumentsAndCall(ParamReceiveSpec(1, 0, true, takes_keywords), NULL, self->d_method->ml_name,
+                                         NULL, NULL, argspec, arg1, arg2, arg3, args, keyword_names, continuation);
+    }
+
     ParamReceiveSpec paramspec(0, 0, false, false);
     Box** defaults = NULL;
     if (call_flags == METH_NOARGS) {
@@ -288,24 +323,17 @@ Box* methodDescrTppCall(Box* _self, CallRewriteArgs* rewrite_args, ArgPassSpec a
     bool arg1_class_guarded = false;
     if (rewrite_args && argspec.num_args >= 1) {
         // Try to do the guard before rearrangeArguments if possible:
-        rewrite_args->arg1->addAttrGuard(offsetof(Box, cls), (intptr_t)arg1->cls);
+        rewrite_args->arg1->addClsGuard(arg1->cls);
         arg1_class_guarded = true;
     }
 
     auto continuation = [=](CallRewriteArgs* rewrite_args, Box* arg1, Box* arg2, Box* arg3, Box** args) {
-        if (is_classmethod) {
+        check_self(arg1);
+        if (is_classmethod)
             rewrite_args = NULL;
-            if (!PyType_Check(arg1))
-                raiseExcHelper(TypeError, "descriptor '%s' requires a type but received a '%s'",
-                               self->d_method->ml_name, getFullTypeName(arg1).c_str());
-        } else {
-            if (!isSubclass(arg1->cls, self->d_type))
-                raiseExcHelper(TypeError, "descriptor '%s' requires a '%s' arg1 but received a '%s'",
-                               self->d_method->ml_name, self->d_type->tp_name, getFullTypeName(arg1).c_str());
-        }
 
         if (rewrite_args && !arg1_class_guarded) {
-            rewrite_args->arg1->addAttrGuard(offsetof(Box, cls), (intptr_t)arg1->cls);
+            rewrite_args->arg1->addClsGuard(arg1->cls);
         }
 
         Box* rtn;
@@ -274,7 +274,11 @@ void logException(ExcInfo* exc_info) {
 
 extern "C" void caughtCapiException() {
     PyThreadState* tstate = PyThreadState_GET();
+    bool is_reraise = getIsReraiseFlag();
     exceptionAtLine(&tstate->curexc_traceback);
+    if (unlikely(_Py_TracingPossible) && !is_reraise)
+        traceFrameException((FrameInfo*)tstate->frame_info, tstate->curexc_type, tstate->curexc_value,
+                            tstate->curexc_traceback);
 }
 
 extern "C" void reraiseCapiExcAsCxx() {
@@ -296,7 +300,11 @@ void caughtCxxException(ExcInfo* exc_info) {
     static StatCounter frames_unwound("num_frames_unwound_python");
     frames_unwound.log();
 
+    bool is_reraise = getIsReraiseFlag();
     exceptionAtLine(&exc_info->traceback);
+    if (unlikely(_Py_TracingPossible) && !is_reraise)
+        traceFrameException((FrameInfo*)cur_thread_state.frame_info, exc_info->type, exc_info->value,
+                            exc_info->traceback);
 }
 
 struct ExcState {
@@ -35,7 +35,7 @@ class BoxedFrame : public Box {
 private:
     // Call boxFrame to get a BoxedFrame object.
     BoxedFrame(FrameInfo* frame_info) __attribute__((visibility("default")))
-    : frame_info(frame_info), _back(NULL), _code(NULL), _globals(NULL), _locals(NULL), _linenumber(-1) {}
+    : frame_info(frame_info), _back(NULL), _code(NULL), _globals(NULL), _locals(NULL), _trace(NULL), _linenumber(-1) {}
 
 public:
     FrameInfo* frame_info;
@@ -44,6 +44,7 @@ public:
     Box* _code;
     Box* _globals;
     Box* _locals;
+    Box* _trace; // the local trace function that sys.settrace() installed for this frame
 
     int _linenumber;
 
@@ -65,7 +66,7 @@ public:
 
     // writable attributes
     //
-    // f_trace[*]         : if not None, is a function called at the start of each source code line (used by debugger)
+    // f_trace            : if not None, is a function called at the start of each source code line (used by debugger)
     // f_exc_type[*],     : represent the last exception raised in the parent frame provided another exception was
     // f_exc_value[*],    : ever raised in the current frame (in all other cases they are None).
     // f_exc_traceback[*] :
@@ -132,6 +133,20 @@ public:
 
     static Box* f_back(Box* obj, void* arg) noexcept { return incref(back(obj, arg)); }
 
+    static Box* f_trace(Box* obj, void*) noexcept {
+        auto f = static_cast<BoxedFrame*>(obj);
+        return incref(f->_trace ? f->_trace : Py_None);
+    }
+
+    static int set_f_trace(Box* obj, Box* val, void*) noexcept {
+        auto f = static_cast<BoxedFrame*>(obj);
+        // Deleting the attribute or setting it to None both mean "no local trace function":
+        Box* old_trace = f->_trace;
+        f->_trace = (val && val != Py_None) ? incref(val) : NULL;
+        Py_XDECREF(old_trace);
+        return 0;
+    }
+
     static Box* lineno(Box* obj, void*) noexcept {
         auto f = static_cast<BoxedFrame*>(obj);
 
@@ -186,6 +201,7 @@ public:
         Py_VISIT(o->_code);
         Py_VISIT(o->_globals);
         Py_VISIT(o->_locals);
+        Py_VISIT(o->_trace);
         return 0;
     }
     static int clear(Box* self) noexcept {
@@ -194,6 +210,7 @@ public:
         Py_CLEAR(o->_code);
         Py_CLEAR(o->_globals);
         Py_CLEAR(o->_locals);
+        Py_CLEAR(o->_trace);
         return 0;
     }
 
@@ -237,6 +254,13 @@ void frameInvalidateBack(BoxedFrame* frame) {
 }
 
 extern "C" void initFrame(FrameInfo* frame_info) {
+    initDeoptedFrame(frame_info);
+
+    if (unlikely(_Py_TracingPossible))
+        traceFrameCall(frame_info);
+}
+
+void initDeoptedFrame(FrameInfo* frame_info) noexcept {
     frame_info->back = (FrameInfo*)(cur_thread_state.frame_info);
     cur_thread_state.frame_info = frame_info;
 }
@@ -262,13 +286,13 @@ void FrameInfo::disableDeinit(FrameInfo* replacement_frame) {
     assert(isDisabledFrame());
 }
 
-extern "C" void deinitFrameMaybe(FrameInfo* frame_info) noexcept {
+extern "C" void deinitFrameMaybe(FrameInfo* frame_info, Box* retval) noexcept {
     // Note: this has to match FrameInfo::disableDeinit
     if (!frame_info->isDisabledFrame())
-        deinitFrame(frame_info);
+        deinitFrame(frame_info, retval);
 }
 
-extern "C" void deinitFrame(FrameInfo* frame_info) noexcept {
+extern "C" void deinitFrame(FrameInfo* frame_info, Box* retval) noexcept {
     // This can fire if we have a call to deinitFrame() that should be to deinitFrameMaybe() instead
     assert(!frame_info->isDisabledFrame());
 
@@ -280,6 +304,9 @@ extern "C" void deinitFrame(FrameInfo* frame_info) noexcept {
         PyErr_Clear();
     }
 
+    if (unlikely(_Py_TracingPossible))
+        traceFrameReturn(frame_info, retval);
+
     if (frame_info->exc.type) {
         Py_CLEAR(frame_info->exc.type);
         Py_CLEAR(frame_info->exc.value);
@@ -311,6 +338,98 @@ extern "C" void deinitFrame(FrameInfo* frame_info) noexcept {
         PyErr_Restore(err_type, err_value, err_tb);
 }
 
+extern "C" {
+int _Py_TracingPossible = 0;
+}
+
+// Like CPython's call_trace_protected(), except that errors don't propagate: frame entry and exit can't throw in
+// all tiers.  The sys.setprofile() / sys.settrace() trampolines uninstall a hook that raised, so we just report it.
+static void callTraceHooks(FrameInfo* frame_info, int what, Box* arg) noexcept {
+    PyThreadState* tstate = &cur_thread_state;
+    if (tstate->tracing || !tstate->use_tracing)
+        return;
+    if (what == PyTrace_EXCEPTION && !tstate->c_tracefunc)
+        return;
+
+    Box* type, *value, *tb;
+    PyErr_Fetch(&type, &value, &tb);
+
+    Box* frame = BoxedFrame::boxFrame(frame_info);
+    if (!arg)
+        arg = Py_None;
+
+    tstate->tracing++;
+    tstate->use_tracing = 0;
+    int r = 0;
+    // Profile functions only get call and return events.
+    if (tstate->c_profilefunc && what != PyTrace_EXCEPTION)
+        r = tstate->c_profilefunc(tstate->c_profileobj, (PyFrameObject*)frame, what, arg);
+    if (r == 0 && tstate->c_tracefunc)
+        r = tstate->c_tracefunc(tstate->c_traceobj, (PyFrameObject*)frame, what, arg);
+    tstate->use_tracing = (tstate->c_profilefunc != NULL || tstate->c_tracefunc != NULL);
+    tstate->tracing--;
+
+    if (r != 0)
+        PyErr_WriteUnraisable(frame);
+
+    PyErr_Restore(type, value, tb);
+}
+
+void traceFrameCall(FrameInfo* frame_info) noexcept {
+    callTraceHooks(frame_info, PyTrace_CALL, NULL);
+}
+
+void traceFrameReturn(FrameInfo* frame_info, Box* retval) noexcept {
+    callTraceHooks(frame_info, PyTrace_RETURN, retval);
+}
+
+void traceFrameException(FrameInfo* frame_info, Box* type, Box* value, Box* tb) noexcept {
+    if (!cur_thread_state.c_tracefunc)
+        return;
+
+    Box* arg = PyTuple_Pack(3, type, value ? value : Py_None, tb ? tb : Py_None);
+    if (!arg) {
+        PyErr_Clear();
+        return;
+    }
+    callTraceHooks(frame_info, PyTrace_EXCEPTION, arg);
+    Py_DECREF(arg);
+}
+
+extern "C" void PyEval_SetProfile(Py_tracefunc func, PyObject* arg) noexcept {
+    PyThreadState* tstate = &cur_thread_state;
+    _Py_TracingPossible += (func != NULL) - (tstate->c_profilefunc != NULL);
+
+    PyObject* temp = tstate->c_profileobj;
+    Py_XINCREF(arg);
+    tstate->c_profilefunc = NULL;
+    tstate->c_profileobj = NULL;
+    /* Must make sure that tracing is not ignored if 'temp' is freed */
+    tstate->use_tracing = tstate->c_tracefunc != NULL;
+    Py_XDECREF(temp);
+    tstate->c_profilefunc = func;
+    tstate->c_profileobj = arg;
+    /* Flag that tracing or profiling is turned on */
+    tstate->use_tracing = (func != NULL) || (tstate->c_tracefunc != NULL);
+}
+
+extern "C" void PyEval_SetTrace(Py_tracefunc func, PyObject* arg) noexcept {
+    PyThreadState* tstate = &cur_thread_state;
+    _Py_TracingPossible += (func != NULL) - (tstate->c_tracefunc != NULL);
+
+    PyObject* temp = tstate->c_traceobj;
+    Py_XINCREF(arg);
+    tstate->c_tracefunc = NULL;
+    tstate->c_traceobj = NULL;
+    /* Must make sure that profiling is not ignored if 'temp' is freed */
+    tstate->use_tracing = tstate->c_profilefunc != NULL;
+    Py_XDECREF(temp);
+    tstate->c_tracefunc = func;
+    tstate->c_traceobj = arg;
+    /* Flag that tracing or profiling is turned on */
+    tstate->use_tracing = ((func != NULL) || (tstate->c_profilefunc != NULL));
+}
+
 int frameinfo_traverse(FrameInfo* frame_info, visitproc visit, void* arg) noexcept {
     Py_VISIT(frame_info->frame_obj);
 
@@ -377,6 +496,14 @@ extern "C" BORROWED(PyObject*) PyFrame_GetCode(PyFrameObject* f) noexcept {
     return BoxedFrame::code((Box*)f, NULL);
 }
 
+extern "C" BORROWED(PyObject*) PyFrame_GetTrace(PyFrameObject* f) noexcept {
+    return ((BoxedFrame*)f)->_trace;
+}
+
+extern "C" void PyFrame_SetTrace(PyFrameObject* f, PyObject* trace) noexcept {
+    BoxedFrame::set_f_trace((Box*)f, trace, NULL);
+}
+
 extern "C" PyFrameObject* PyFrame_ForStackLevel(int stack_level) noexcept {
     return (PyFrameObject*)getFrame(stack_level);
 }
@@ -392,6 +519,7 @@ void setupFrame() {
 
     frame_cls->giveAttrDescriptor("f_globals", BoxedFrame::f_globals, NULL);
     frame_cls->giveAttrDescriptor("f_back", BoxedFrame::f_back, NULL);
+    frame_cls->giveAttrDescriptor("f_trace", BoxedFrame::f_trace, BoxedFrame::set_f_trace);
 
     frame_cls->freeze();
 }
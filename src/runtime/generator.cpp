@@ -372,6 +372,10 @@ static Box* yieldInternal(BoxedGenerator* obj, STOLEN(Box*) value,
     // caller
     assert(self->top_caller_frame_info == generator_frame_info->back);
 
+    // like CPython, profilers see a yield as a return from the generator and resuming it as a new call
+    if (unlikely(_Py_TracingPossible))
+        traceFrameReturn(generator_frame_info, value);
+
     // reset current frame to the caller tops frame --> removes the frame the generator added
     cur_thread_state.frame_info = self->top_caller_frame_info;
     obj->paused_frame_info = generator_frame_info;
@@ -392,6 +396,9 @@ static Box* yieldInternal(BoxedGenerator* obj, STOLEN(Box*) value,
     }
     cur_thread_state.frame_info = generator_frame_info;
 
+    if (unlikely(_Py_TracingPossible))
+        traceFrameCall(generator_frame_info);
+
     // if the generator receives a exception from the caller we have to throw it
     if (self->exception.type) {
         ExcInfo e = self->exception;
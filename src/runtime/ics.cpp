@@ -18,9 +18,11 @@
 
 #include "asm_writing/icinfo.h"
 #include "asm_writing/rewriter.h"
+#include "codegen/codegen.h"
 #include "codegen/compvars.h"
 #include "codegen/memmgr.h"
 #include "codegen/patchpoints.h"
+#include "codegen/profiling/jitdump.h"
 #include "codegen/stackmaps.h"
 #include "core/common.h"
 #include "core/options.h"
@@ -297,6 +299,10 @@ RuntimeIC::RuntimeIC(void* func_addr, int total_size) {
             memcpy(eh_frame_addr, _eh_frame_template_fp, _eh_frame_template_fp_size);
         register_eh_frame.updateAndRegisterFrameFromTemplate((uint64_t)addr, total_code_size, (uint64_t)eh_frame_addr,
                                                              EH_FRAME_SIZE);
+
+        if (PERF_JITDUMP)
+            jitdumpCodeLoad("runtime_ic:" + g.func_addr_registry.getFuncNameAtAddress(func_addr, true), addr,
+                            total_code_size);
     } else {
         addr = func_addr;
     }
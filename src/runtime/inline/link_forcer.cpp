@@ -145,6 +145,9 @@ void force() {
     FORCE(div_i64_i64);
     FORCE(mod_i64_i64);
     FORCE(pow_i64_i64);
+    FORCE(add_i64_i64);
+    FORCE(sub_i64_i64);
+    FORCE(mul_i64_i64);
 
     FORCE(div_float_float);
     FORCE(floordiv_float_float);
@@ -63,18 +63,116 @@ int _PyLong_DigitValue[256] = {
 #define IS_LITTLE_ENDIAN (int)*(unsigned char*)&one
 #define PY_ABS_LLONG_MIN (0 - (unsigned PY_LONG_LONG)PY_LLONG_MIN)
 
+void BoxedLong::initSet(mpz_srcptr v) {
+    int size = v->_mp_size;
+    int abs_size = size < 0 ? -size : size;
+    if (abs_size > NUM_INLINE_LIMBS) {
+        mpz_init_set(n, v);
+        return;
+    }
+
+    for (int i = 0; i < abs_size; i++)
+        inline_limbs[i] = v->_mp_d[i];
+    n->_mp_alloc = 0;
+    n->_mp_size = size;
+    n->_mp_d = inline_limbs;
+}
+
+void BoxedLong::shrinkToInline() {
+    assert(!isInline());
+    int size = n->_mp_size;
+    int abs_size = size < 0 ? -size : size;
+    if (abs_size > NUM_INLINE_LIMBS)
+        return;
+
+    mpz_t heap;
+    *heap = *n;
+    initSet(heap);
+    mpz_clear(heap);
+}
+
 void BoxedLong::tp_dealloc(Box* b) noexcept {
-    mpz_clear(static_cast<BoxedLong*>(b)->n);
+    BoxedLong* l = static_cast<BoxedLong*>(b);
+    if (!l->isInline())
+        mpz_clear(l->n);
     b->cls->tp_free(b);
 }
 
+// Fast paths for small values: these work on the magnitude of any long that fits in NUM_INLINE_LIMBS limbs
+// (whether or not it is actually stored inline), and produce inline results without calling into GMP.
+static inline bool getSmallMagnitude(mpz_srcptr v, unsigned __int128& magnitude) {
+    int size = v->_mp_size;
+    switch (size < 0 ? -size : size) {
+        case 0:
+            magnitude = 0;
+            return true;
+        case 1:
+            magnitude = v->_mp_d[0];
+            return true;
+        case 2:
+            magnitude = v->_mp_d[0] | ((unsigned __int128)v->_mp_d[1] << 64);
+            return true;
+        default:
+            return false;
+    }
+}
+
+static inline bool isNegative(mpz_srcptr v) {
+    return v->_mp_size < 0;
+}
+
+// Returns a new long with the value of a + b (given as sign and magnitude), or NULL if the result doesn't fit in
+// the inline representation.
+static BoxedLong* smallAdd(unsigned __int128 a, bool a_negative, unsigned __int128 b, bool b_negative) {
+    unsigned __int128 magnitude;
+    bool negative;
+    if (a_negative == b_negative) {
+        magnitude = a + b;
+        if (magnitude < a) // carry out of the top limb
+            return NULL;
+        negative = a_negative;
+    } else if (a >= b) {
+        magnitude = a - b;
+        negative = a_negative;
+    } else {
+        magnitude = b - a;
+        negative = b_negative;
+    }
+
+    BoxedLong* r = new BoxedLong();
+    r->initInline(magnitude, negative);
+    return r;
+}
+
+// Returns a new long with the value of a * b, or NULL if the result might not fit in the inline representation.
+static BoxedLong* smallMul(unsigned __int128 a, bool a_negative, unsigned __int128 b, bool b_negative) {
+    if ((a >> 64) || (b >> 64))
+        return NULL;
+
+    BoxedLong* r = new BoxedLong();
+    r->initInline(a * b, a_negative != b_negative);
+    return r;
+}
+
+static inline int smallCompare(unsigned __int128 a, bool a_negative, unsigned __int128 b, bool b_negative) {
+    // Zero is never negative, so differing signs mean the values differ.
+    if (a_negative != b_negative)
+        return a_negative ? -1 : 1;
+    int c = a < b ? -1 : (a > b ? 1 : 0);
+    return a_negative ? -c : c;
+}
+
+static inline unsigned __int128 intMagnitude(int64_t v) {
+    return v < 0 ? -(uint64_t)v : (uint64_t)v;
+}
+
 extern "C" int _PyLong_Sign(PyObject* l) noexcept {
     return mpz_sgn(static_cast<BoxedLong*>(l)->n);
 }
 
 extern "C" PyObject* _PyLong_Copy(PyLongObject* src) noexcept {
     BoxedLong* rtn = new BoxedLong();
-    mpz_init_set(rtn->n, ((BoxedLong*)src)->n);
+    rtn->initSet(((BoxedLong*)src)->n);
     return rtn;
 }
 
@@ -236,6 +334,7 @@ extern "C" PyObject* PyLong_FromString(const char* str, char** pend, int base) n
     if (sign == -1)
         mpz_neg(rtn->n, rtn->n);
 
+    rtn->shrinkToInline();
     return rtn;
 }
 
@@ -424,12 +523,13 @@ extern "C" PyObject* PyLong_FromDouble(double v) noexcept {
 
     BoxedLong* rtn = new BoxedLong();
     mpz_init_set_d(rtn->n, v);
+    rtn->shrinkToInline();
     return rtn;
 }
 
 extern "C" PyObject* PyLong_FromLong(long ival) noexcept {
     BoxedLong* rtn = new BoxedLong();
-    mpz_init_set_si(rtn->n, ival);
+    rtn->initInline(ival);
     return rtn;
 }
 
@@ -453,7 +553,7 @@ extern "C" PyObject* PyLong_FromUnicode(Py_UNICODE* u, Py_ssize_t length, int ba
 
 extern "C" PyObject* PyLong_FromUnsignedLong(unsigned long ival) noexcept {
     BoxedLong* rtn = new BoxedLong();
-    mpz_init_set_ui(rtn->n, ival);
+    rtn->initInline(ival, false);
     return rtn;
 }
 
@@ -627,6 +727,7 @@ extern "C" PyObject* _PyLong_FromByteArray(const unsigned char* bytes, size_t n,
         mpz_clear(t);
     }
 
+    rtn->shrinkToInline();
     return rtn;
 }
 
@@ -637,7 +738,7 @@ extern "C" void _PyLong_AsMPZ(PyObject* obj, _PyLongMPZ num) noexcept {
 
 extern "C" PyObject* _PyLong_FromMPZ(const _PyLongMPZ num) noexcept {
     BoxedLong* r = new BoxedLong();
-    mpz_init_set(r->n, (mpz_srcptr)num);
+    r->initSet((mpz_srcptr)num);
     return r;
 }
 
@@ -646,24 +747,25 @@ extern "C" Box* createLong(llvm::StringRef s) {
     assert(s.data()[s.size()] == '\0');
     int r = mpz_init_set_str(rtn->n, s.data(), 10);
     RELEASE_ASSERT(r == 0, "%d: '%s'", r, s.data());
+    rtn->shrinkToInline();
     return rtn;
 }
 
 extern "C" BoxedLong* boxLong(int64_t n) {
     BoxedLong* rtn = new BoxedLong();
-    mpz_init_set_si(rtn->n, n);
+    rtn->initInline(n);
     return rtn;
 }
 
 extern "C" PyObject* PyLong_FromLongLong(long long ival) noexcept {
     BoxedLong* rtn = new BoxedLong();
-    mpz_init_set_si(rtn->n, ival);
+    rtn->initInline(ival);
     return rtn;
 }
 
 extern "C" PyObject* PyLong_FromUnsignedLongLong(unsigned long long ival) noexcept {
     BoxedLong* rtn = new BoxedLong();
-    mpz_init_set_ui(rtn->n, ival);
+    rtn->initInline(ival, false);
     return rtn;
 }
 
@@ -773,7 +875,7 @@ template <ExceptionStyle S> Box* longNew(Box* _cls, Box* val, Box* base) noexcep
 
     BoxedLong* rtn = new (cls) BoxedLong();
 
-    mpz_init_set(rtn->n, l->n);
+    rtn->initSet(l->n);
     return rtn;
 }
 
@@ -786,7 +888,7 @@ Box* longInt(Box* v) {
     static_assert(sizeof(BoxedInt::n) == sizeof(long), "");
     if (overflow) {
         BoxedLong* rtn = new BoxedLong();
-        mpz_init_set(rtn->n, ((BoxedLong*)v)->n);
+        rtn->initSet(((BoxedLong*)v)->n);
         return rtn;
     } else
         return boxInt(n);
@@ -798,7 +900,7 @@ Box* longToLong(Box* self) noexcept {
     } else {
         assert(PyLong_Check(self));
         BoxedLong* l = new BoxedLong();
-        mpz_init_set(l->n, static_cast<BoxedLong*>(self)->n);
+        l->initSet(static_cast<BoxedLong*>(self)->n);
         return l;
     }
 }
@@ -895,9 +997,17 @@ Box* longNeg(BoxedLong* v1) {
     if (!PyLong_Check(v1))
         raiseExcHelper(TypeError, "descriptor '__neg__' requires a 'long' object but received a '%s'", getTypeName(v1));
 
+    unsigned __int128 magnitude;
+    if (getSmallMagnitude(v1->n, magnitude)) {
+        BoxedLong* r = new BoxedLong();
+        r->initInline(magnitude, !isNegative(v1->n) && magnitude != 0);
+        return r;
+    }
+
     BoxedLong* r = new BoxedLong();
     mpz_init(r->n);
     mpz_neg(r->n, v1->n);
+    r->shrinkToInline();
     return r;
 }
 
@@ -909,16 +1019,24 @@ Box* longPos(BoxedLong* v) {
         return incref(v);
     } else {
         BoxedLong* r = new BoxedLong();
-        mpz_init_set(r->n, v->n);
+        r->initSet(v->n);
         return r;
     }
 }
 
 Box* longAbs(BoxedLong* v1) {
     assert(PyLong_Check(v1));
+    unsigned __int128 magnitude;
+    if (getSmallMagnitude(v1->n, magnitude)) {
+        BoxedLong* r = new BoxedLong();
+        r->initInline(magnitude, false);
+        return r;
+    }
+
     BoxedLong* r = new BoxedLong();
     mpz_init(r->n);
     mpz_abs(r->n, v1->n);
+    r->shrinkToInline();
     return r;
 }
 
@@ -926,22 +1044,35 @@ Box* longAdd(BoxedLong* v1, Box* _v2) {
     if (!PyLong_Check(v1))
         raiseExcHelper(TypeError, "descriptor '__add__' requires a 'long' object but received a '%s'", getTypeName(v1));
 
+    unsigned __int128 m1, m2;
     if (PyLong_Check(_v2)) {
         BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
 
+        if (getSmallMagnitude(v1->n, m1) && getSmallMagnitude(v2->n, m2)) {
+            if (BoxedLong* r = smallAdd(m1, isNegative(v1->n), m2, isNegative(v2->n)))
+                return r;
+        }
+
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_add(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
 
+        if (getSmallMagnitude(v1->n, m1)) {
+            if (BoxedLong* r = smallAdd(m1, isNegative(v1->n), intMagnitude(v2->n), v2->n < 0))
+                return r;
+        }
+
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         if (v2->n >= 0)
             mpz_add_ui(r->n, v1->n, v2->n);
         else
             mpz_sub_ui(r->n, v1->n, -v2->n);
+        r->shrinkToInline();
         return r;
     } else {
         return incref(NotImplemented);
@@ -957,6 +1088,7 @@ extern "C" Box* longAnd(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_and(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2_int = static_cast<BoxedInt*>(_v2);
@@ -970,6 +1102,7 @@ extern "C" Box* longAnd(BoxedLong* v1, Box* _v2) {
             mpz_init_set_si(v2_long, v2_int->n);
 
         mpz_and(r->n, v1->n, v2_long);
+        r->shrinkToInline();
         return r;
     }
     return incref(NotImplemented);
@@ -983,6 +1116,7 @@ extern "C" Box* longOr(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_ior(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2_int = static_cast<BoxedInt*>(_v2);
@@ -996,6 +1130,7 @@ extern "C" Box* longOr(BoxedLong* v1, Box* _v2) {
             mpz_init_set_si(v2_long, v2_int->n);
 
         mpz_ior(r->n, v1->n, v2_long);
+        r->shrinkToInline();
         return r;
     }
     return incref(NotImplemented);
@@ -1009,6 +1144,7 @@ extern "C" Box* longXor(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_xor(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2_int = static_cast<BoxedInt*>(_v2);
@@ -1022,6 +1158,7 @@ extern "C" Box* longXor(BoxedLong* v1, Box* _v2) {
             mpz_init_set_si(v2_long, v2_int->n);
 
         mpz_xor(r->n, v1->n, v2_long);
+        r->shrinkToInline();
         return r;
     }
     return incref(NotImplemented);
@@ -1034,6 +1171,10 @@ static PyObject* long_richcompare(Box* _v1, Box* _v2, int op) noexcept {
     if (PyLong_Check(_v2)) {
         BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
 
+        unsigned __int128 m1, m2;
+        if (getSmallMagnitude(v1->n, m1) && getSmallMagnitude(v2->n, m2))
+            return convert_3way_to_object(op, smallCompare(m1, isNegative(v1->n), m2, isNegative(v2->n)));
+
         return convert_3way_to_object(op, mpz_cmp(v1->n, v2->n));
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
@@ -1050,7 +1191,7 @@ Box* convertToLong(Box* val) {
     } else if (PyInt_Check(val)) {
         BoxedInt* val_int = static_cast<BoxedInt*>(val);
         BoxedLong* r = new BoxedLong();
-        mpz_init_set_si(r->n, val_int->n);
+        r->initInline(val_int->n);
         return r;
     } else {
         return incref(NotImplemented);
@@ -1076,6 +1217,7 @@ Box* longLShiftLong(BoxedLong* lhs, Box* _rhs) {
     BoxedLong* r = new BoxedLong();
     mpz_init(r->n);
     mpz_mul_2exp(r->n, lhs->n, n);
+    r->shrinkToInline();
     return r;
 }
 
@@ -1119,6 +1261,7 @@ Box* longRShiftLong(BoxedLong* lhs, Box* _rhs) {
     BoxedLong* r = new BoxedLong();
     mpz_init(r->n);
     mpz_div_2exp(r->n, lhs->n, n);
+    r->shrinkToInline();
     return r;
 }
 
@@ -1165,22 +1308,35 @@ Box* longSub(BoxedLong* v1, Box* _v2) {
     if (!PyLong_Check(v1))
         raiseExcHelper(TypeError, "descriptor '__sub__' requires a 'long' object but received a '%s'", getTypeName(v1));
 
+    unsigned __int128 m1, m2;
     if (PyLong_Check(_v2)) {
         BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
 
+        if (getSmallMagnitude(v1->n, m1) && getSmallMagnitude(v2->n, m2)) {
+            if (BoxedLong* r = smallAdd(m1, isNegative(v1->n), m2, !isNegative(v2->n) && m2 != 0))
+                return r;
+        }
+
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_sub(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
 
+        if (getSmallMagnitude(v1->n, m1)) {
+            if (BoxedLong* r = smallAdd(m1, isNegative(v1->n), intMagnitude(v2->n), v2->n > 0))
+                return r;
+        }
+
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         if (v2->n >= 0)
             mpz_sub_ui(r->n, v1->n, v2->n);
         else
             mpz_add_ui(r->n, v1->n, -v2->n);
+        r->shrinkToInline();
         return r;
     } else {
         return incref(NotImplemented);
@@ -1199,19 +1355,32 @@ Box* longMul(BoxedLong* v1, Box* _v2) {
     if (!PyLong_Check(v1))
         raiseExcHelper(TypeError, "descriptor '__mul__' requires a 'long' object but received a '%s'", getTypeName(v1));
 
+    unsigned __int128 m1, m2;
     if (PyLong_Check(_v2)) {
         BoxedLong* v2 = static_cast<BoxedLong*>(_v2);
 
+        if (getSmallMagnitude(v1->n, m1) && getSmallMagnitude(v2->n, m2)) {
+            if (BoxedLong* r = smallMul(m1, isNegative(v1->n), m2, isNegative(v2->n)))
+                return r;
+        }
+
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_mul(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
 
+        if (getSmallMagnitude(v1->n, m1)) {
+            if (BoxedLong* r = smallMul(m1, isNegative(v1->n), intMagnitude(v2->n), v2->n < 0))
+                return r;
+        }
+
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_mul_si(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else {
         return incref(NotImplemented);
@@ -1231,6 +1400,7 @@ Box* longDiv(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_fdiv_q(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
@@ -1241,6 +1411,7 @@ Box* longDiv(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init_set_si(r->n, v2->n);
         mpz_fdiv_q(r->n, v1->n, r->n);
+        r->shrinkToInline();
         return r;
     } else {
         return incref(NotImplemented);
@@ -1267,6 +1438,7 @@ Box* longMod(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_mmod(r->n, v1->n, v2->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
@@ -1277,6 +1449,7 @@ Box* longMod(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init_set_si(r->n, v2->n);
         mpz_mmod(r->n, v1->n, r->n);
+        r->shrinkToInline();
         return r;
     } else {
         return incref(NotImplemented);
@@ -1322,6 +1495,8 @@ Box* longDivmodLong(BoxedLong* lhs, Box* _rhs) {
     mpz_init(q->n);
     mpz_init(r->n);
     mpz_fdiv_qr(q->n, r->n, lhs->n, rhs_long->n);
+    q->shrinkToInline();
+    r->shrinkToInline();
     return BoxedTuple::create({ q, r });
 }
 
@@ -1363,6 +1538,7 @@ Box* longRdiv(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init(r->n);
         mpz_fdiv_q(r->n, v2->n, v1->n);
+        r->shrinkToInline();
         return r;
     } else if (PyInt_Check(_v2)) {
         BoxedInt* v2 = static_cast<BoxedInt*>(_v2);
@@ -1370,6 +1546,7 @@ Box* longRdiv(BoxedLong* v1, Box* _v2) {
         BoxedLong* r = new BoxedLong();
         mpz_init_set_si(r->n, v2->n);
         mpz_fdiv_q(r->n, r->n, v1->n);
+        r->shrinkToInline();
         return r;
     } else {
         return incref(NotImplemented);
@@ -1508,10 +1685,11 @@ Box* longPowLong(BoxedLong* lhs, Box* _rhs, Box* _mod) {
 
     if (_mod != Py_None) {
         mpz_powm(r->n, lhs->n, rhs_long->n, mod_long->n);
-        if (mpz_sgn(r->n) == 0)
-            return r;
-        if (mpz_sgn(mod_long->n) < 0)
+        // GMP reduces modulo |mod|; a nonzero result has to take the sign of a negative modulus.
+        if (mpz_sgn(r->n) != 0 && mpz_sgn(mod_long->n) < 0)
             return longAdd(autoDecref(r), mod_long);
+        r->shrinkToInline();
+        return r;
     } else {
         if (mpz_fits_ulong_p(rhs_long->n)) {
             uint64_t n2 = mpz_get_ui(rhs_long->n);
@@ -1529,6 +1707,7 @@ Box* longPowLong(BoxedLong* lhs, Box* _rhs, Box* _mod) {
             }
         }
     }
+    r->shrinkToInline();
     return r;
 }
 Box* longPow(BoxedLong* lhs, Box* rhs, Box* mod) {
@@ -1562,6 +1741,7 @@ extern "C" Box* longInvert(BoxedLong* v) {
     BoxedLong* r = new BoxedLong();
     mpz_init(r->n);
     mpz_com(r->n, v->n);
+    r->shrinkToInline();
     return r;
 }
 
@@ -1584,16 +1764,31 @@ Box* longHash(BoxedLong* self) {
         raiseExcHelper(TypeError, "descriptor '__hash__' requires a 'long' object but received a '%s'",
                        getTypeName(self));
 
-    // If the long fits into an int we have to return the same hash in order that we can find the value in a dict.
-    if (mpz_fits_slong_p(self->n)) {
-        auto v = mpz_get_si(self->n);
-        if (v == -1)
-            v = -2;
-        return boxInt(v);
-    }
-
     // CPython use the absolute value of self mod ULONG_MAX.
-    unsigned long remainder = mpz_tdiv_ui(self->n, ULONG_MAX);
+    unsigned long remainder;
+    unsigned __int128 magnitude;
+    if (getSmallMagnitude(self->n, magnitude)) {
+        bool negative = isNegative(self->n);
+
+        // If the long fits into an int we have to return the same hash in order that we can find the value in a
+        // dict.
+        if (magnitude <= (negative ? (uint64_t)LONG_MAX + 1 : (uint64_t)LONG_MAX)) {
+            long v = negative ? (long)(0 - (uint64_t)magnitude) : (long)magnitude;
+            if (v == -1)
+                v = -2;
+            return boxInt(v);
+        }
+
+        // 2**64 == 1 (mod ULONG_MAX), so the remainder is the sum of the two limbs with an end-around carry.
+        uint64_t lo = (uint64_t)magnitude, hi = (uint64_t)(magnitude >> 64);
+        remainder = lo + hi;
+        if (remainder < lo)
+            remainder++;
+        if (remainder == ULONG_MAX)
+            remainder = 0;
+    } else {
+        remainder = mpz_tdiv_ui(self->n, ULONG_MAX);
+    }
     if (remainder == 0)
         remainder = -1; // CPython compatibility -- ULONG_MAX mod ULONG_MAX is ULONG_MAX to them.
 
@@ -1625,7 +1820,7 @@ extern "C" Box* longIndex(BoxedLong* v) noexcept {
     if (PyLong_CheckExact(v))
         return incref(v);
     BoxedLong* rtn = new BoxedLong();
-    mpz_init_set(rtn->n, v->n);
+    rtn->initSet(v->n);
     return rtn;
 }
 
@@ -29,10 +29,41 @@ extern BoxedClass* long_cls;
 
 class BoxedLong : public Box {
 public:
+    static const int NUM_INLINE_LIMBS = 2;
+    static_assert(GMP_LIMB_BITS == 64, "the inline representation assumes 64-bit limbs");
+
+    // Values of up to NUM_INLINE_LIMBS limbs keep their digits in inline_limbs instead of a separate GMP
+    // allocation.  In that case n._mp_d points at inline_limbs and n._mp_alloc is 0 (the same layout that
+    // mpz_roinit_n produces), so n can be read by any mpz_* function but must never be used as an output
+    // operand.  We only ever write to the n of a freshly created BoxedLong, so this is easy to maintain.
     mpz_t n;
+    mp_limb_t inline_limbs[NUM_INLINE_LIMBS];
 
     BoxedLong() __attribute__((visibility("default"))) {}
 
+    bool isInline() const { return n->_mp_d == inline_limbs; }
+
+    // Initializes n to the value sign * magnitude without touching the GMP allocator.
+    void initInline(unsigned __int128 magnitude, bool negative) {
+        inline_limbs[0] = (mp_limb_t)magnitude;
+        inline_limbs[1] = (mp_limb_t)(magnitude >> 64);
+        int size = inline_limbs[1] ? 2 : (inline_limbs[0] ? 1 : 0);
+        n->_mp_alloc = 0;
+        n->_mp_size = negative ? -size : size;
+        n->_mp_d = inline_limbs;
+    }
+    void initInline(int64_t v) {
+        // Negate in unsigned arithmetic so that INT64_MIN doesn't overflow:
+        initInline(v < 0 ? -(uint64_t)v : (uint64_t)v, v < 0);
+    }
+
+    // Initializes n to a copy of v, keeping the limbs inline if they fit.
+    void initSet(mpz_srcptr v);
+
+    // If n was just computed into a heap-allocated mpz and the result is small, move it inline and release
+    // the GMP allocation.
+    void shrinkToInline();
+
     static void tp_dealloc(Box* b) noexcept;
 
     DEFAULT_CLASS_SIMPLE(long_cls, false);
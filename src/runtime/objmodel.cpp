@@ -31,6 +31,7 @@
 #include "codegen/compvars.h"
 #include "codegen/irgen/hooks.h"
 #include "codegen/parser.h"
+#include "codegen/profiling/deopt_trace.h"
 #include "codegen/type_recording.h"
 #include "codegen/unwinding.h"
 #include "core/bst.h"
@@ -136,7 +137,7 @@ extern "C" void xdecrefAndRethrow(void* cxa_ptr, int num, ...) {
     rawReraise(e.type, e.value, e.traceback);
 }
 
-extern "C" Box* deopt(Box* value) {
+extern "C" Box* deopt(Box* value, BoxedClass* expected_cls) {
     ASSERT(ENABLE_FRAME_INTROSPECTION, "deopt will not work with frame introspection turned off");
 
     STAT_TIMER(t0, "us_timer_deopt", 10);
@@ -146,8 +147,24 @@ extern "C" Box* deopt(Box* value) {
 
     auto deopt_state = getDeoptState();
 
+    CompiledFunction* cf = deopt_state.cf;
+    BoxedCode* code = cf->code_obj;
+
+    DeoptEvent event;
+    event.kind = DeoptKind::DEOPT;
+    event.name = code->name->s().str();
+    event.filename = code->filename->s().str();
+    event.lineno = deopt_state.current_stmt->lineno;
+    event.node = BST_TYPE::stringify(deopt_state.current_stmt->type());
+    event.expected_cls = getNameOfClass(expected_cls);
+    event.actual_cls = getNameOfClass(value->cls);
+    event.from_tier = FrameTier::LLVM;
+    event.to_tier = FrameTier::INTERPRETER;
+    event.effort = (int)cf->effort;
+
     // Should we only do this selectively?
-    deopt_state.cf->speculationFailed();
+    event.version_invalidated = cf->speculationFailed();
+    logDeopt(std::move(event));
 
     // Except of exc.type we skip initializing the exc fields inside the JITed code path (small perf improvement) that's
     // why we have todo it now if we didn't set an exception (which sets all fields)
@@ -1067,7 +1084,7 @@ template <Rewritable rewritable> BORROWED(Box*) Box::getattr(BoxedString* attr,
     // creating a single field that encompasses the relevant other fields
     // so that it can still be a single guard rather than multiple.
     if (rewrite_args && !rewrite_args->obj_shape_guarded)
-        rewrite_args->obj->addAttrGuard(offsetof(Box, cls), (intptr_t)cls);
+        rewrite_args->obj->addClsGuard(cls);
 
 #if 0
     if (attr.data()[0] == '_' && attr.data()[1] == '_') {
@@ -1230,7 +1247,7 @@ static HCAttrs::AttrList* allocFromFreelist(int freelist_idx) {
     }
 
     int nattrs = (1 << freelist_idx) * INITIAL_ARRAY_SIZE;
-    return (HCAttrs::AttrList*)PyObject_MALLOC(sizeof(HCAttrs::AttrList) + nattrs * sizeof(Box*));
+    return (HCAttrs::AttrList*)_PyObject_MallocFast(sizeof(HCAttrs::AttrList) + nattrs * sizeof(Box*));
 }
 
 static HCAttrs::AttrList* allocAttrs(int nattrs) {
@@ -1507,7 +1524,7 @@ void Box::setattr(BoxedString* attr, BORROWED(Box*) val, SetattrRewriteArgs* rew
     // structure (ex user class) and the same hidden classes, because
     // otherwise the guard will fail anyway.;
     if (rewrite_args)
-        rewrite_args->obj->addAttrGuard(offsetof(Box, cls), (intptr_t)cls);
+        rewrite_args->obj->addClsGuard(cls);
 
     RELEASE_ASSERT(attr->s() != none_str || this == builtins_module, "can't assign to None");
 
@@ -1744,6 +1761,7 @@ BORROWED(Box*) typeLookup(BoxedClass* cls, BoxedString* attr, GetattrRewriteArgs
         // TODO this can fail if we replace the mro with another mro that lives in the same
         // address.
         obj_saved->addAttrGuard(offsetof(BoxedClass, tp_mro), (intptr_t)mro);
+        rewrite_args->rewriter->addGuardedClass(cls);
 
         for (auto base : *mro) {
             if (rewrite_args) {
@@ -1824,6 +1842,7 @@ BORROWED(Box*) typeLookup(BoxedClass* cls, BoxedString* attr, GetattrRewriteArgs
             static_assert(sizeof(BoxedClass::tp_version_tag) == 8, "addAttrGuard only supports 64bit values");
             obj_saved->addAttrGuard(offsetof(BoxedClass, tp_flags), (intptr_t)cls->tp_flags);
             obj_saved->addAttrGuard(offsetof(BoxedClass, tp_version_tag), (intptr_t)cls->tp_version_tag);
+            rewrite_args->rewriter->addGuardedClass(cls);
             if (!val)
                 rewrite_args->setReturn(NULL, ReturnConvention::NO_RETURN);
             else {
@@ -1992,7 +2011,7 @@ Box* descriptorClsSpecialCases(GetattrRewriteArgs* rewrite_args, BoxedClass* cls
     // Special case: functions
     if (descr->cls == function_cls || descr->cls == instancemethod_cls) {
         if (rewrite_args)
-            r_descr->addAttrGuard(offsetof(Box, cls), (uint64_t)descr->cls);
+            r_descr->addClsGuard(descr->cls);
 
         // TODO: we need to change this to support instancemethod_checking.py
         if (!for_call && descr->cls == function_cls) {
@@ -2017,7 +2036,7 @@ Box* descriptorClsSpecialCases(GetattrRewriteArgs* rewrite_args, BoxedClass* cls
     // in instance lookups
     if (descr->cls == &PyMemberDescr_Type || descr->cls == &PyWrapperDescr_Type) {
         if (rewrite_args)
-            r_descr->addAttrGuard(offsetof(Box, cls), (uint64_t)descr->cls);
+            r_descr->addClsGuard(descr->cls);
 
         if (rewrite_args) {
             // This is assuming that r_descr was passed in as a valid object
@@ -2544,7 +2563,7 @@ Box* getattrInternalGeneric(Box* obj, BoxedString* attr, GetattrRewriteArgs* rew
         descr_get = descr->cls->tp_descr_get;
 
         if (rewrite_args)
-            r_descr->addAttrGuard(offsetof(Box, cls), (uint64_t)descr->cls);
+            r_descr->addClsGuard(descr->cls);
 
         // Special-case data descriptors (e.g., member descriptors)
         Box* res = dataDescriptorInstanceSpecialCases<rewritable>(rewrite_args, attr, obj, descr, r_descr, for_call,
@@ -3091,7 +3110,7 @@ void setattrGeneric(Box* obj, BoxedString* attr, STOLEN(Box*) val, SetattrRewrit
         // This is the same for functions, but for non-functions we have to explicitly run it
         // through the descriptor protocol.
         if (rewrite_args && _set_->cls == function_cls) {
-            r_set->addAttrGuard(offsetof(Box, cls), (uint64_t)_set_->cls);
+            r_set->addClsGuard(_set_->cls);
 
             CallRewriteArgs crewrite_args(rewrite_args->rewriter, r_set, Location::any());
             crewrite_args.arg1 = r_descr;
@@ -3278,7 +3297,7 @@ extern "C" bool nonzero(Box* obj) {
     RewriterVar* r_obj = NULL;
     if (rewriter.get()) {
         r_obj = rewriter->getArg(0)->setType(RefType::BORROWED);
-        r_obj->addAttrGuard(offsetof(Box, cls), (intptr_t)obj->cls);
+        r_obj->addClsGuard(obj->cls);
     }
 
     // Note: it feels silly to have all these special cases here, and we should probably be
@@ -3704,18 +3723,18 @@ Box* callattrInternal(Box* obj, BoxedString* attr, LookupScope scope, CallattrRe
         // or because they only need to fit into an UNKNOWN slot.
 
         if (npassed_args >= 1)
-            rewrite_args->arg1->addAttrGuard(offsetof(Box, cls), (intptr_t)arg1->cls);
+            rewrite_args->arg1->addClsGuard(arg1->cls);
         if (npassed_args >= 2)
-            rewrite_args->arg2->addAttrGuard(offsetof(Box, cls), (intptr_t)arg2->cls);
+            rewrite_args->arg2->addClsGuard(arg2->cls);
         if (npassed_args >= 3)
-            rewrite_args->arg3->addAttrGuard(offsetof(Box, cls), (intptr_t)arg3->cls);
+            rewrite_args->arg3->addClsGuard(arg3->cls);
 
         if (npassed_args > 3) {
             for (int i = 3; i < npassed_args; i++) {
                 // TODO if there are a lot of args (>16), might be better to increment a pointer
                 // rather index them directly?
                 RewriterVar* v = rewrite_args->args->getAttr((i - 3) * sizeof(Box*), Location::any());
-                v->addAttrGuard(offsetof(Box, cls), (intptr_t)args[i - 3]->cls);
+                v->addClsGuard(args[i - 3]->cls);
             }
         }
 
@@ -4217,8 +4236,7 @@ Box* rearrangeArgumentsAndCallInternal(ParamReceiveSpec paramspec, const ParamNa
             Box* given_varargs = getArg(argspec.num_args + argspec.num_keywords, arg1, arg2, arg3, args);
             if (given_varargs->cls == tuple_cls) {
                 if (rewrite_args) {
-                    getArg(argspec.num_args + argspec.num_keywords, rewrite_args)
-                        ->addAttrGuard(offsetof(Box, cls), (intptr_t)tuple_cls);
+                    getArg(argspec.num_args + argspec.num_keywords, rewrite_args)->addClsGuard(tuple_cls);
                 }
                 return continuation(rewrite_args, arg1, arg2, arg3, args);
             }
@@ -4365,17 +4383,7 @@ Box* rearrangeArgumentsAndCallInternal(ParamReceiveSpec paramspec, const ParamNa
                                                                         : Location::any())->setType(RefType::BORROWED);
             } else {
                 assert(varargs_size <= 6);
-                void* create_ptrs[] = {
-                    NULL,                       //
-                    (void*)BoxedTuple::create1, //
-                    (void*)BoxedTuple::create2, //
-                    (void*)BoxedTuple::create3, //
-                    (void*)BoxedTuple::create4, //
-                    (void*)BoxedTuple::create5, //
-                    (void*)BoxedTuple::create6, //
-                };
-                varargs_val = rewrite_args->rewriter->call(true, create_ptrs[varargs_size], unused_positional_rvars)
-                                  ->setType(RefType::OWNED);
+                varargs_val = rewrite_args->rewriter->createTuple(unused_positional_rvars);
                 varargs_owned = true;
             }
 
@@ -4952,6 +4960,18 @@ Box* callCLFunc(BoxedCode* code, CallRewriteArgs* rewrite_args, int num_output_a
 
         assert(!generator);
 
+        // A type-specialized version is only valid for the argument classes it was picked for.
+        if (!chosen_cf->spec->accepts_all_inputs) {
+            for (int i = 0; i < num_output_args; i++) {
+                if (chosen_cf->spec->arg_types[i] == UNKNOWN)
+                    continue;
+
+                Box* arg = getArg(i, oarg1, oarg2, oarg3, oargs);
+                assert(arg);
+                getArg(i, rewrite_args)->addClsGuard(arg->cls);
+            }
+        }
+
         RewriterVar::SmallVector arg_vec;
 
         void* func_ptr = (void*)chosen_cf->call;
@@ -5227,11 +5247,11 @@ Box* runtimeCallInternal(Box* obj, CallRewriteArgs* rewrite_args, ArgPassSpec ar
                         // kwargs.
                         getArg(i, rewrite_args)->addGuard(0);
                     } else {
-                        getArg(i, rewrite_args)->addAttrGuard(offsetof(Box, cls), (intptr_t)v->cls);
+                        getArg(i, rewrite_args)->addClsGuard(v->cls);
                     }
                 } else {
                     assert(v);
-                    getArg(i, rewrite_args)->addAttrGuard(offsetof(Box, cls), (intptr_t)v->cls);
+                    getArg(i, rewrite_args)->addClsGuard(v->cls);
                 }
             }
             rewrite_args->args_guarded = true;
@@ -5408,6 +5428,8 @@ static Box* runtimeCallEntry(Box* obj, ArgPassSpec argspec, Box* arg1, Box* arg2
         // or this kind of thing is necessary in a lot more places
         // rewriter->getArg(1).addGuard(npassed_args);
 
+        rewriter->getICInfo()->recordCallee(obj);
+
         CallRewriteArgs rewrite_args(rewriter.get(), rewriter->getArg(0)->setType(RefType::BORROWED),
                                      rewriter->getReturnDestination());
         if (npassed_args >= 1)
@@ -5561,8 +5583,8 @@ Box* binopInternal(Box* lhs, Box* rhs, int op_type, BinopRewriteArgs* rewrite_ar
 
         if (func) {
             if (rewrite_args) {
-                rewrite_args->lhs->addAttrGuard(offsetof(Box, cls), (intptr_t)lhs->cls);
-                rewrite_args->rhs->addAttrGuard(offsetof(Box, cls), (intptr_t)rhs->cls);
+                rewrite_args->lhs->addClsGuard(lhs->cls);
+                rewrite_args->rhs->addClsGuard(rhs->cls);
                 RewriterVar* r_ret = rewrite_args->rewriter->call(true, (void*)func, rewrite_args->lhs,
                                                                   rewrite_args->rhs)->setType(RefType::OWNED);
                 rewrite_args->rewriter->checkAndThrowCAPIException(r_ret);
@@ -5901,8 +5923,8 @@ Box* compareInternal(Box* lhs, Box* rhs, int op_type, CompareRewriteArgs* rewrit
         // removed is probably the later one.
         // ie we should have some way of specifying what we know about the values
         // of objects and their attributes, and the attributes' attributes.
-        rewrite_args->lhs->addAttrGuard(offsetof(Box, cls), (intptr_t)lhs->cls);
-        rewrite_args->rhs->addAttrGuard(offsetof(Box, cls), (intptr_t)rhs->cls);
+        rewrite_args->lhs->addClsGuard(lhs->cls);
+        rewrite_args->rhs->addClsGuard(rhs->cls);
     }
 
     // TODO: switch from our op types to cpythons
@@ -6210,7 +6232,7 @@ static std::pair<RewriterVar*, RewriterVar*> extractIntSliceStartStop(std::uniqu
     RewriterVar* r_stop_int = NULL;
     if (start) {
         r_start->addGuardNotEq(0);
-        r_start->addAttrGuard(offsetof(Box, cls), (uint64_t)int_cls);
+        r_start->addClsGuard(int_cls);
         r_start_int = r_start->getAttr(offsetof(BoxedInt, n));
         r_start_int->addGuardNotLt0();
     } else {
@@ -6219,7 +6241,7 @@ static std::pair<RewriterVar*, RewriterVar*> extractIntSliceStartStop(std::uniqu
     }
     if (stop) {
         r_stop->addGuardNotEq(0);
-        r_stop->addAttrGuard(offsetof(Box, cls), (uint64_t)int_cls);
+        r_stop->addClsGuard(int_cls);
         r_stop_int = r_stop->getAttr(offsetof(BoxedInt, n));
         r_stop_int->addGuardNotLt0();
     } else {
@@ -7352,7 +7374,7 @@ extern "C" Box* getGlobal(Box* globals, BoxedString* name) {
                 // Guard on it being a module rather than a dict
                 // TODO is this guard necessary? I'm being conservative now, but I think we can just
                 // insist that the type passed in is fixed for any given instance of a getGlobal call.
-                r_mod->addAttrGuard(offsetof(Box, cls), (intptr_t)module_cls);
+                r_mod->addClsGuard(module_cls);
 
                 GetattrRewriteArgs rewrite_args(rewriter.get(), r_mod, rewriter->getReturnDestination());
                 r = m->getattr(name, &rewrite_args);
@@ -7448,7 +7470,7 @@ extern "C" void setGlobal(Box* globals, BoxedString* name, STOLEN(Box*) value) {
                                             rewriter->getArg(2)->setType(RefType::OWNED));
             rewriter->getArg(1)->setType(RefType::BORROWED);
 
-            rewrite_args.obj->addAttrGuard(offsetof(Box, cls), (uint64_t)globals->cls);
+            rewrite_args.obj->addClsGuard(globals->cls);
 
             setattrInternal(globals, name, value, &rewrite_args);
 
@@ -45,7 +45,7 @@ void _printStacktrace();
 // to see if they are getting called from jitted code.  If we inline them into a function that
 // got called from jitted code, they might incorrectly think that they are a rewritable entrypoint.
 
-extern "C" Box* deopt(Box* value) __attribute__((noinline));
+extern "C" Box* deopt(Box* value, BoxedClass* expected_cls) __attribute__((noinline));
 
 // helper function for raising from the runtime:
 void raiseExcHelper(BoxedClass*, const char* fmt, ...) __attribute__((__noreturn__))
@@ -83,6 +83,10 @@ extern "C" BoxedInt* len(Box* obj) __attribute__((noinline));
 extern "C" i64 unboxedLen(Box* obj) __attribute__((noinline));
 extern "C" Box* binop(Box* lhs, Box* rhs, int op_type) __attribute__((noinline));
 extern "C" Box* augbinop(Box* lhs, Box* rhs, int op_type) __attribute__((noinline));
+// Fast path for `x += y` on str when x is a local that the result gets stored straight back into, and `*local` plus
+// `lhs` are the only references to the string: appends to it in place (as CPython's ceval does) instead of copying.
+// Consumes `lhs` and returns the result on success; returns NULL with `lhs` untouched if the fast path doesn't apply.
+extern "C" Box* strInplaceConcat(Box* lhs, Box* rhs, Box** local);
 extern "C" Box* getitem(Box* value, Box* slice) __attribute__((noinline));
 extern "C" Box* getitem_capi(Box* value, Box* slice) noexcept __attribute__((noinline));
 extern "C" void setitem(Box* target, Box* slice, Box* value) __attribute__((noinline));
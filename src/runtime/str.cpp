@@ -369,6 +369,30 @@ template <ExceptionStyle S> Box* strAdd(BoxedString* lhs, Box* _rhs) noexcept(S
     return new (lhs->size() + rhs->size()) BoxedString(lhs->s(), rhs->s());
 }
 
+extern "C" Box* strInplaceConcat(Box* lhs, Box* rhs, Box** local) {
+    if (lhs->cls != str_cls || rhs->cls != str_cls || *local != lhs || Py_REFCNT(lhs) != 2
+        || PyString_CHECK_INTERNED(lhs))
+        return NULL;
+
+    static StatCounter sc("num_str_inplace_concat");
+    sc.log();
+
+    // Drop the local's reference so that ours is the only one and the string can be resized.  Afterwards the local
+    // gets a reference to the (possibly moved) result, which the store that follows will replace.
+    Py_DECREF(lhs);
+
+    Py_ssize_t lhs_size = Py_SIZE(lhs);
+    Py_ssize_t rhs_size = Py_SIZE(rhs);
+    if (_PyString_Resize(&lhs, lhs_size + rhs_size) < 0) {
+        *local = NULL;
+        throwCAPIException();
+    }
+    memcpy(PyString_AS_STRING(lhs) + lhs_size, PyString_AS_STRING(rhs), rhs_size);
+
+    *local = incref(lhs);
+    return lhs;
+}
+
 /* Format codes
  * F_LJUST      '-'
  * F_SIGN       '+'
@@ -71,6 +71,7 @@ BoxedString* internStringImmortal(llvm::StringRef s) noexcept {
     interned_strings.insert((BoxedString*)entry);
 
     Py_INCREF(entry);
+    _Py_SetImmortal(entry);
     return entry;
 }
 
@@ -101,6 +102,7 @@ extern "C" void PyString_InternInPlace(PyObject** p) noexcept {
 
         // CPython returns mortal but in our current implementation they are inmortal
         s->interned_state = SSTATE_INTERNED_IMMORTAL;
+        _Py_SetImmortal(s);
     }
 }
 
@@ -29,6 +29,26 @@ namespace pyston {
 #if PyTuple_MAXSAVESIZE > 0
 BoxedTuple* BoxedTuple::free_list[PyTuple_MAXSAVESIZE];
 int BoxedTuple::numfree[PyTuple_MAXSAVESIZE];
+
+// Called from Rewriter-emitted code when free_list[nitems] is empty: allocates a fresh tuple and pushes it
+// so that the inline pop can proceed.  Returns the new head.
+BoxedTuple* BoxedTuple::refillFreeList(int64_t nitems) {
+    assert(nitems > 0 && nitems < PyTuple_MAXSAVESIZE);
+    assert(free_list[nitems] == NULL);
+
+    // Objects on the freelist are not live objects yet: the inline pop does the _Py_NewReference (and with it the
+    // allocation profiler's countdown), so don't let PyObject_GC_NewVar do it a second time.
+    BoxedTuple* op = static_cast<BoxedTuple*>(_PyObject_GC_MallocFast(_PyObject_VAR_SIZE(&PyTuple_Type, nitems)));
+    if (!op)
+        throwCAPIException();
+    op->cls = &PyTuple_Type;
+    op->ob_size = nitems;
+
+    op->elts[0] = (Box*)free_list[nitems];
+    free_list[nitems] = op;
+    numfree[nitems]++;
+    return op;
+}
 #endif
 
 extern "C" Box* createTuple(int64_t nelts, Box** elts) {
@@ -29,6 +29,7 @@
 #include "capi/types.h"
 #include "codegen/ast_interpreter.h"
 #include "codegen/entry.h"
+#include "codegen/profiling/jitdump.h"
 #include "codegen/unwinding.h"
 #include "core/bst.h"
 #include "core/options.h"
@@ -67,6 +68,7 @@ extern "C" void init_heapq();
 extern "C" void initimp();
 extern "C" void init_io();
 extern "C" void inititertools();
+extern "C" void init_lsprof();
 extern "C" void initmath();
 extern "C" void init_md5();
 extern "C" void initoperator();
@@ -109,9 +111,9 @@ extern "C" PyObject* PyType_GenericAlloc(PyTypeObject* type, Py_ssize_t nitems)
     // I think that regardless of the reasoning behind them having it, we should do what they do?
 
     if (PyType_IS_GC(type))
-        obj = _PyObject_GC_Malloc(size);
+        obj = _PyObject_GC_MallocFast(size);
     else
-        obj = (PyObject*)PyObject_MALLOC(size);
+        obj = (PyObject*)_PyObject_MallocFast(size);
 
     if (obj == NULL)
         return PyErr_NoMemory();
@@ -837,14 +839,14 @@ static Box* typeCallInner(CallRewriteArgs* rewrite_args, ArgPassSpec argspec, Bo
             // or because they only need to fit into an UNKNOWN slot.
 
             if (npassed_args >= 1)
-                rewrite_args->arg1->addAttrGuard(offsetof(Box, cls), (intptr_t)arg1->cls);
+                rewrite_args->arg1->addClsGuard(arg1->cls);
             if (npassed_args >= 2)
-                rewrite_args->arg2->addAttrGuard(offsetof(Box, cls), (intptr_t)arg2->cls);
+                rewrite_args->arg2->addClsGuard(arg2->cls);
             if (npassed_args >= 3)
-                rewrite_args->arg3->addAttrGuard(offsetof(Box, cls), (intptr_t)arg3->cls);
+                rewrite_args->arg3->addClsGuard(arg3->cls);
             for (int i = 3; i < npassed_args; i++) {
                 RewriterVar* v = rewrite_args->args->getAttr((i - 3) * sizeof(Box*), Location::any());
-                v->addAttrGuard(offsetof(Box, cls), (intptr_t)args[i - 3]->cls);
+                v->addClsGuard(args[i - 3]->cls);
             }
             rewrite_args->args_guarded = true;
         }
@@ -960,13 +962,13 @@ static Box* typeCallInner(CallRewriteArgs* rewrite_args, ArgPassSpec argspec, Bo
                 && (arg2->cls == int_cls || arg2->cls == str_cls || arg2->cls == float_cls
                     || arg2->cls == unicode_cls)) {
                 which_init = NO_INIT;
-                rewrite_args->arg2->addAttrGuard(offsetof(Box, cls), (intptr_t)arg2->cls);
+                rewrite_args->arg2->addClsGuard(arg2->cls);
             }
 
             // str(obj) can return str-subtypes, but for builtin types it won't:
             if (argspec.num_args == 2 && cls == str_cls && (arg2->cls == int_cls || arg2->cls == float_cls)) {
                 which_init = MAKES_CLS;
-                rewrite_args->arg2->addAttrGuard(offsetof(Box, cls), (intptr_t)arg2->cls);
+                rewrite_args->arg2->addClsGuard(arg2->cls);
             }
 
             // int(str, base) can only return int/long
@@ -4131,6 +4133,7 @@ struct _inittab _PyImport_Inittab[] = { { "array", initarray },
                                         { "imp", initimp },
                                         { "_io", init_io },
                                         { "itertools", inititertools },
+                                        { "_lsprof", init_lsprof },
                                         { "marshal", PyMarshal_Init },
                                         { "math", initmath },
                                         { "_md5", init_md5 },
@@ -4719,6 +4722,14 @@ void setupRuntime() {
 
     setupSysEnd();
 
+    // Everything created so far stays alive until shutdown, so stop refcounting it (see _Py_IsImmortal):
+    for (auto b : constants)
+        _Py_SetImmortal(b);
+    for (auto b : late_constants)
+        _Py_SetImmortal(b);
+    for (auto b : classes)
+        _Py_SetImmortal(b);
+
     TRACK_ALLOCATIONS = true;
 }
 
@@ -4782,6 +4793,8 @@ extern "C" void Py_Finalize() noexcept {
 
     if (PROFILE)
         g.func_addr_registry.dumpPerfMap();
+    if (PERF_JITDUMP)
+        jitdumpClose();
 
     call_sys_exitfunc();
     // initialized = 0;
@@ -4796,6 +4809,11 @@ extern "C" void Py_Finalize() noexcept {
 #ifdef Py_REF_DEBUG
     IN_SHUTDOWN = true;
 
+    // Let the immortal objects (and the frozen ones, which are immortal too) get freed like everything else, so that
+    // the leak check below covers them.
+    _Py_ReleaseImmortals();
+    _PyGC_Unfreeze();
+
     // May need to run multiple collections to collect everything:
     while (true) {
         clearAllICs();
@@ -298,9 +298,9 @@ template <bool is_gc> void* Box::newFast(size_t size, BoxedClass* cls) {
     /* note: we want to use size instead of tp_basicsize, since size is a compile-time constant */
     void* mem;
     if (is_gc)
-        mem = _PyObject_GC_Malloc(size);
+        mem = _PyObject_GC_MallocFast(size);
     else
-        mem = PyObject_MALLOC(size);
+        mem = _PyObject_MallocFast(size);
     assert(mem);
 
     Box* rtn = static_cast<Box*>(mem);
@@ -633,7 +633,7 @@ public:
         assert(str_cls->is_pyston_class);
         assert(str_cls->attrs_offset == 0);
 
-        void* mem = PyObject_MALLOC(sizeof(BoxedString) + 1 + nitems);
+        void* mem = _PyObject_MallocFast(sizeof(BoxedString) + 1 + nitems);
         assert(mem);
 
         BoxVar* rtn = static_cast<BoxVar*>(mem);
@@ -972,6 +972,12 @@ public:
     static void dealloc(PyTupleObject* op) noexcept;
     friend int PyTuple_ClearFreeList() noexcept;
 
+    // The Rewriter emits the freelist pop from operator new inline (see Rewriter::createTuple); these are its
+    // out-of-line slow paths.
+    friend class Rewriter;
+    static BoxedTuple* refillFreeList(int64_t nitems);
+    static BoxedTuple* allocateUninitialized(int64_t nitems) { return new (nitems) BoxedTuple(); }
+
     operator llvm::ArrayRef<Box*>() const { return llvm::ArrayRef<Box*>(this->elts, size()); }
 };
 static_assert(sizeof(BoxedTuple) == sizeof(PyTupleObject), "");
@@ -1170,6 +1176,9 @@ public:
 
     // Profiling counter:
     int propagated_cxx_exceptions = 0;
+    // Set when a version gets thrown away for failing its speculations, until the next version gets compiled; only
+    // used to attribute that compile in the jit event log.
+    bool killed_version_for_speculation_failure = false;
 
     // For use by the interpreter/baseline jit:
     int times_interpreted;
@@ -1178,6 +1187,11 @@ public:
     ICInvalidator dependent_interp_callsites;
     llvm::DenseMap<BST_stmt*, int> cxx_exception_count;
 
+    // Objects that the llvm-compiled versions of this code embed pointers to, and which therefore have to stay alive
+    // as long as those versions can run (ex the targets of direct calls).  Holds a reference to each of them.
+    std::vector<Box*> jit_kept_alive;
+    void keepAliveForJit(Box* obj);
+
 
     // Functions can provide an "internal" version, which will get called instead
     // of the normal dispatch through the functionlist.
@@ -1503,10 +1517,22 @@ extern Box* dict_descr;
 BORROWED(Box*) getFrame(FrameInfo* frame_info);
 BORROWED(Box*) getFrame(int depth);
 void frameInvalidateBack(BoxedFrame* frame);
-extern "C" void deinitFrame(FrameInfo* frame_info) noexcept;
-extern "C" void deinitFrameMaybe(FrameInfo* frame_info) noexcept;
+// retval is only used for reporting the return to a profile or trace function; pass NULL if we are unwinding.
+extern "C" void deinitFrame(FrameInfo* frame_info, Box* retval) noexcept;
+extern "C" void deinitFrameMaybe(FrameInfo* frame_info, Box* retval) noexcept;
 int frameinfo_traverse(FrameInfo* frame_info, visitproc visit, void* arg) noexcept;
 extern "C" void initFrame(FrameInfo* frame_info);
+// Like initFrame, for when the interpreter takes over a frame from the LLVM tier: the call already got reported to
+// any profile or trace function when that tier entered it.
+void initDeoptedFrame(FrameInfo* frame_info) noexcept;
+
+// The number of profile and trace functions (see PyEval_SetProfile) installed in any thread.  Frame entry and exit
+// in all tiers go through initFrame() and deinitFrame(), which is where we check this.
+extern "C" int _Py_TracingPossible;
+void traceFrameCall(FrameInfo* frame_info) noexcept;
+void traceFrameReturn(FrameInfo* frame_info, Box* retval) noexcept;
+void traceFrameException(FrameInfo* frame_info, Box* type, Box* value, Box* tb) noexcept;
+
 extern "C" void setFrameExcInfo(FrameInfo* frame_info, STOLEN(Box*) type, STOLEN(Box*) value, STOLEN(Box*) tb);
 
 inline BoxedString* boxString(llvm::StringRef s) {
@@ -59,11 +59,42 @@ dict_API_test(PyObject* self, PyObject* args) {
     return Py_BuildValue("OO", Py_None, Py_None);
 }
 
+#if defined(PYSTON_VERSION)
+// Returns its positional arguments as a tuple and its keyword arguments as a dict.
+static PyObject*
+fastcall_args(PyObject* self, PyObject* const* args, Py_ssize_t nargs, PyObject* kwnames) {
+    Py_ssize_t i, nkw = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    PyObject* pos = PyTuple_New(nargs);
+    PyObject* kw = PyDict_New();
+    PyObject* r;
+    for (i = 0; i < nargs; i++) {
+        Py_INCREF(args[i]);
+        PyTuple_SET_ITEM(pos, i, args[i]);
+    }
+    for (i = 0; i < nkw; i++)
+        PyDict_SetItem(kw, PyTuple_GET_ITEM(kwnames, i), args[nargs + i]);
+    r = Py_BuildValue("OO", pos, kw);
+    Py_DECREF(pos);
+    Py_DECREF(kw);
+    return r;
+}
+#define FASTCALL_ARGS_FLAGS (METH_FASTCALL | METH_KEYWORDS)
+#else
+static PyObject*
+fastcall_args(PyObject* self, PyObject* args, PyObject* kwargs) {
+    if (kwargs)
+        return Py_BuildValue("OO", args, kwargs);
+    return Py_BuildValue("ON", args, PyDict_New());
+}
+#define FASTCALL_ARGS_FLAGS (METH_VARARGS | METH_KEYWORDS)
+#endif
+
 static PyMethodDef TestMethods[] = {
     {"set_size",  set_size, METH_O, "Get set size by PySet_Size." },
     {"test_attrwrapper_parse",  test_attrwrapper_parse, METH_VARARGS, "Test PyArg_ParseTuple for attrwrappers." },
     {"change_self",  change_self, METH_VARARGS, "A function which the self point to its base class."},
     {"dict_API_test",  dict_API_test, METH_VARARGS, ""},
+    {"fastcall_args",  (PyCFunction)fastcall_args, FASTCALL_ARGS_FLAGS, ""},
     {NULL, NULL, 0, NULL}        /* Sentinel */
 };
 
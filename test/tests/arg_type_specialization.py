@@ -0,0 +1,32 @@
+# run_args: -n
+# The first jitted version of a function gets specialized on int and float argument classes;
+# calls with other classes have to fall back to a generic version.
+
+def f(x, y):
+    return x * y + x
+
+for i in xrange(2000):
+    r = f(1.5 * i, 2.0)
+print r
+
+for i in xrange(2000):
+    r = f(i, 3)
+print r
+
+class F(float):
+    pass
+
+print f(F(2.5), 2.0), f(2, 2.5), f("a", 3), f(True, True), f(2L, 3)
+
+# A polymorphic caller: once the specialized version exists, the mismatching calls should get a generic
+# version right away rather than staying in the interpreter.
+def g(x, y):
+    return x + y
+
+t = 0
+for i in xrange(3000):
+    if i % 3:
+        t += g(i, 1)
+    else:
+        t += len(g("a" * (i % 7), "b"))
+print t
@@ -32,3 +32,34 @@ try:
     assert(a.__dict__['value'] == 42)
 except ImportError:
     pass
+
+# fastcall_args uses METH_FASTCALL on Pyston:
+for i in xrange(1000):
+    r = api_test.fastcall_args(i, 2, 3, 4, 5, 6, 7, 8, 9)
+print r
+# Up to six positional arguments get rewritten into a direct call:
+for i in xrange(1000):
+    r = api_test.fastcall_args(i, 2, 3, 4, 5, 6)
+print r
+for i in xrange(1000):
+    r = api_test.fastcall_args(i, 2)
+    r2 = api_test.fastcall_args()
+print r, r2
+# Keyword calls at a call site that has been warmed up with positional ones:
+def g(i):
+    if i < 900:
+        return api_test.fastcall_args(i, 2, 3)
+    return api_test.fastcall_args(i, 2, c=3)
+for i in xrange(1000):
+    r = g(i)
+    if i in (899, 900, 999):
+        print r
+def h(i, kw):
+    return api_test.fastcall_args(i, **kw)
+for i in xrange(1000):
+    r = h(i, {} if i < 900 else {'c': i})
+    if i in (899, 900, 999):
+        print r
+print api_test.fastcall_args()
+print api_test.fastcall_args(1, b=2)
+print api_test.fastcall_args(*(1, 2), **{'c': 3})
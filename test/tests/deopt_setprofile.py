@@ -0,0 +1,44 @@
+# skip-if: '-L' in EXTRA_JIT_ARGS or '-n' in EXTRA_JIT_ARGS
+# statcheck: 1 <= noninit_count('num_deopt')
+# Make a type speculation fail while a profile function is installed: the
+# interpreter takes over the frame the LLVM tier entered, and the profile
+# function should still see exactly one call and one return for it.
+
+import sys
+
+try:
+    import __pyston__
+    __pyston__.setOption("OSR_THRESHOLD_BASELINE", 50)
+    __pyston__.setOption("REOPT_THRESHOLD_BASELINE", 50)
+    __pyston__.setOption("SPECULATION_THRESHOLD", 10)
+except ImportError:
+    pass
+
+class C(object):
+    pass
+
+def f(o):
+    x = o.a
+    return x + 1
+
+c = C()
+c.a = 1
+t = 0
+for i in xrange(2000):
+    t += f(c)
+print t
+
+events = []
+def prof(frame, event, arg):
+    if frame.f_code is f.__code__ and event in ("call", "return"):
+        events.append(event)
+
+sys.setprofile(prof)
+c.a = 1.0
+for i in xrange(5):
+    t += f(c)
+sys.setprofile(None)
+print t
+
+print events.count("call"), events.count("return")
+print events == ["call", "return"] * 5
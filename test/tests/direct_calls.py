@@ -0,0 +1,73 @@
+# Call sites that always call the same small Python function, and what happens
+# when that changes after the caller got compiled.
+
+def add(a, b):
+    return a + b
+
+def mul(a, b):
+    return a * b
+
+def getx(o):
+    return o.x
+
+class C(object):
+    def __init__(self, x):
+        self.x = x
+
+def f(n, func):
+    t = 0
+    for i in xrange(n):
+        t = func(t, i)
+    return t
+
+print f(20000, add)
+print f(10, mul)
+print f(10, lambda a, b: a - b)
+
+def g(n):
+    t = 0
+    objs = [C(i) for i in xrange(10)]
+    for i in xrange(n):
+        t += getx(objs[i % 10])
+    return t
+
+print g(20000)
+getx.__code__ = (lambda o: -o.x).__code__
+print g(100)
+
+def raises(a, b):
+    return a / b
+
+def h(n):
+    for i in xrange(n):
+        try:
+            raises(1, i % 2)
+        except ZeroDivisionError:
+            pass
+    return n
+
+print h(20000)
+
+# The call-site feedback only holds a weak reference: a callee that only the
+# feedback refers to goes away.
+import weakref
+
+def make_callee():
+    def callee(a, b):
+        return a + b + 1
+    return callee
+
+def k(n, func):
+    t = 0
+    for i in xrange(n):
+        t = func(t, i)
+    return t
+
+callee = make_callee()
+r = weakref.ref(callee)
+print k(20000, callee)
+del callee
+import gc
+gc.collect()
+print r() is None
+print k(100, make_callee())
@@ -0,0 +1,42 @@
+# None, bools, small ints, interned strings and builtin types are immortal: taking and dropping
+# lots of references to them must keep working, and must not change their refcounts.
+
+import sys
+
+def f(n):
+    l = []
+    for i in xrange(n):
+        l.append((None, True, False, i % 100, "abc", int, type(None)))
+        d = {}
+        d.get(i)
+        x = None
+        y = x
+        z = [y, y, y]
+    del l
+    return None
+
+def refcounts():
+    return [sys.getrefcount(o) for o in (None, True, False, 5, int, type(None))]
+
+# Warm up (so that the code objects and the jitted code don't hold any new references), then churn some more;
+# immortal refcounts stay pinned, and otherwise all the references got dropped again.
+for i in xrange(100):
+    f(1000)
+before = refcounts()
+for i in xrange(100):
+    f(1000)
+after = refcounts()
+print before == after
+
+try:
+    import __pyston__
+    # Debug builds keep exact counts (see _Py_IsImmortal), on top of the immortal refcount.
+    print all(c >= 2 ** 61 for c in after)
+except ImportError:
+    print True
+
+s = intern("some interned " + "string")
+print s is intern("some interned string"), sys.getrefcount(s) > 0
+del s
+print intern("some interned string")
+print None, True, False, 5, type(None)
@@ -0,0 +1,32 @@
+# run_args: -n
+# Int add/sub/mul get lowered to overflow-checked native arithmetic in the llvm tier;
+# make sure that overflowing still promotes to long.
+
+import sys
+
+def f(a, b):
+    return a + b, a - b, a * b
+
+for i in xrange(2000):
+    r = f(sys.maxint - 1000 + i, i)
+    if i % 250 == 0:
+        print r, map(type, r)
+
+x = 1
+for i in xrange(200):
+    x = x * 3 + i
+    if i % 20 == 0:
+        print x, type(x)
+
+def lcg(n):
+    s = 12345
+    t = 0
+    for i in xrange(n):
+        s = (s * 1103515245 + 12345) % 2147483648
+        t += s
+        t -= i
+    return s, t
+print lcg(10000)
+
+m = -sys.maxint - 1
+print m - 1, m * -1, m * 1, type(m * 1)
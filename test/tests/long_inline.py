@@ -0,0 +1,34 @@
+# Longs that fit in two limbs are stored inline and have their own arithmetic fast paths;
+# check them around the boundaries where we switch representations.
+
+import sys
+
+vals = [0L, 1L, -1L, 2L ** 31, sys.maxint, sys.maxint + 1, -sys.maxint - 1, -sys.maxint - 2,
+        2L ** 64 - 1, 2L ** 64, -(2L ** 64), 2L ** 127, 2L ** 128 - 1, 2L ** 128, -(2L ** 128) + 1,
+        -(2L ** 128), 2L ** 200 + 12345]
+
+for a in vals:
+    print a, -a, abs(a), hash(a), hash(a) == hash(int(a)) if -sys.maxint - 1 <= a <= sys.maxint else None
+    for b in vals + [0, 1, -1, 7, sys.maxint, -sys.maxint - 1]:
+        print a + b, a - b, b - a, a * b, a < b, a == b, a > b, cmp(a, b)
+        if b:
+            print a // b, a % b, divmod(a, b)
+
+d = {}
+for i in xrange(100):
+    d[sys.maxint + i] = i
+    d[(sys.maxint + 1) * i] = i
+print sorted(d.items())[:10], len(d)
+
+t = sys.maxint * 1000
+s = 0L
+for i in xrange(1000):
+    s += t + i
+    s -= t
+print s, type(s)
+
+# 3-arg pow: zero results, negative moduli, and small results of big operands
+for base, exp, mod in [(6L, 2L, 4L), (4L, 3L, 8L), (0L, 5L, 7L), (3L, 4L, -5L), (-3L, 3L, -7L), (10L, 3L, -1L),
+                       (2L, 100L, 2L ** 64 + 1), (2L ** 100, 3L, 7L), (2L ** 100, 2L ** 70, 2L ** 130 - 1),
+                       (-(2L ** 65), 3L, 1000L), (5L, 0L, 3L), (5L, 0L, -3L)]:
+    print base, exp, mod, pow(base, exp, mod)
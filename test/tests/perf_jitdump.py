@@ -0,0 +1,36 @@
+# run_args: -J
+# The jitdump file gets written while we are running, so we can look at it from the inside.
+
+import os
+import struct
+
+def f(n):
+    t = 0
+    for i in xrange(n):
+        t += i * 2
+    return t
+
+print f(10000)
+
+def read_records(data):
+    magic, version, header_size = struct.unpack("<III", data[:12])
+    print hex(magic), version, header_size
+
+    names = []
+    offset = header_size
+    while offset < len(data):
+        id, size = struct.unpack("<II", data[offset:offset + 8])
+        if id == 0:
+            name_start = offset + 56
+            names.append(data[name_start:data.index('\0', name_start)])
+        offset += size
+    assert offset == len(data)
+    return names
+
+try:
+    import __pyston__
+    names = read_records(open("/tmp/jit-%d.dump" % os.getpid(), "rb").read())
+    print any(n.startswith("bjit:f ") for n in names)
+except ImportError:
+    print "0x4a695444", 1, 40
+    print True
@@ -0,0 +1,60 @@
+# Sample the allocations of a loop that keeps some of its objects alive and
+# throws the others away, and check that the profile sees both while the live
+# view only sees the ones that were kept.
+
+class Kept(object):
+    pass
+
+class Temp(object):
+    pass
+
+kept = []
+
+def work(n):
+    for i in xrange(n):
+        t = Temp()
+        kept.append(Kept())
+
+N = 50000
+
+try:
+    import __pyston__
+except ImportError:
+    __pyston__ = None
+
+def by_type(entries):
+    r = {}
+    for e in entries:
+        r[e["type"]] = r.get(e["type"], 0) + e["count"]
+    return r
+
+if __pyston__:
+    __pyston__.startAllocProfiler(4096)
+work(N)
+if __pyston__:
+    __pyston__.stopAllocProfiler()
+
+    profile = __pyston__.getAllocProfile()
+    print all(e["samples"] > 0 and e["count"] >= e["samples"] and e["bytes"] > 0 for e in profile)
+    print [e["bytes"] for e in profile] == sorted([e["bytes"] for e in profile], reverse=True)
+    counts = by_type(profile)
+    print 0.7 < counts["Kept"] / N < 1.3, 0.7 < counts["Temp"] / N < 1.3
+    print any(e["type"] == "Kept" and e["stack"].split(";")[-1].startswith("work (") for e in profile)
+
+    live = by_type(__pyston__.getLiveAllocs())
+    print 0.7 < live["Kept"] / N < 1.3, live.get("Temp", 0) < 0.1 * N
+
+    del kept[:]
+    live = by_type(__pyston__.getLiveAllocs())
+    print live.get("Kept", 0) < 0.1 * N
+
+    __pyston__.getAllocProfile(True)
+    print __pyston__.getAllocProfile()
+else:
+    print True
+    print True
+    print True, True
+    print True
+    print True, True
+    print True
+    print []
@@ -0,0 +1,37 @@
+# Allocations get counted per pymalloc size class, and nearly all of them should take the inline fast path.
+
+class C(object):
+    pass
+
+def work(n):
+    kept = []
+    for i in xrange(n):
+        kept.append(C())
+        t = (i, i)
+    return len(kept)
+
+N = 20000
+
+try:
+    import __pyston__
+except ImportError:
+    __pyston__ = None
+
+def totals():
+    if __pyston__ is None:
+        return 0, 0
+    fast = slow = 0
+    for size, f, s in __pyston__.getAllocSizeClasses():
+        assert size % 8 == 0 and 0 < size <= 512, size
+        fast += f
+        slow += s
+    return fast, slow
+
+fast0, slow0 = totals()
+print work(N)
+fast1, slow1 = totals()
+
+if __pyston__ is None:
+    fast1 += N
+print fast1 - fast0 >= N
+print (fast1 - fast0) > 10 * (slow1 - slow0)
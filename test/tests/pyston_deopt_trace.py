@@ -0,0 +1,60 @@
+# skip-if: '-L' in EXTRA_JIT_ARGS or '-n' in EXTRA_JIT_ARGS
+# Make a type speculation fail and a loop OSR, and check that the deopt trace
+# says where it happened and why.
+
+try:
+    import __pyston__
+    __pyston__.setOption("OSR_THRESHOLD_BASELINE", 50)
+    __pyston__.setOption("REOPT_THRESHOLD_BASELINE", 50)
+    __pyston__.setOption("SPECULATION_THRESHOLD", 10)
+except ImportError:
+    __pyston__ = None
+
+class C(object):
+    pass
+
+def f(o):
+    return o.a
+
+F_LINE = f.__code__.co_firstlineno + 1
+
+def loop(n):
+    while n:
+        n -= 1
+    return n
+
+c = C()
+c.a = 1
+t = 0
+for i in xrange(2000):
+    if i == 1500:
+        c.a = 1.0
+    t += f(c)
+print t
+print loop(100000)
+
+if __pyston__:
+    sites = [s for s in __pyston__.getDeoptSites() if s["name"] == "f"]
+    print len(sites), sites[0]["lineno"] == F_LINE, sites[0]["expected"], sites[0]["actual"].keys()
+    print sites[0]["count"] == sum(sites[0]["actual"].values())
+
+    events = __pyston__.getDeopts()
+    deopts = [e for e in events if e["kind"] == "deopt" and e["name"] == "f"]
+    print len(deopts) == sites[0]["count"], deopts[0]["from_tier"], deopts[0]["to_tier"]
+    print any(e["invalidated"] for e in deopts)
+
+    osrs = [e for e in events if e["kind"] == "osr" and e["name"] == "loop"]
+    print bool(osrs), all(e["from_tier"] in ("interp", "bjit") and e["to_tier"] == "llvm" for e in osrs)
+    print osrs[0]["node"], osrs[0]["expected"]
+
+    __pyston__.getDeopts(True)
+    __pyston__.getDeoptSites(True)
+    print __pyston__.getDeopts(), __pyston__.getDeoptSites()
+else:
+    print 1, True, "int", ["float"]
+    print True
+    print True, "llvm", "interp"
+    print True
+    print True, True
+    print "Jump", None
+    print [], []
@@ -0,0 +1,56 @@
+# Objects alive at freeze time should keep working normally afterwards, but be out of the
+# collector's reach; the collector should still handle everything created later.
+
+import gc
+
+class C(object):
+    def __init__(self, n):
+        self.n = n
+
+d = {"a": [1, 2], "b": "x" * 10, "c": C(5)}
+l = [C(i) for i in xrange(100)]
+
+class Cycle(object):
+    def __init__(self):
+        self.me = self
+
+import weakref
+frozen_cycle = Cycle()
+frozen_cycle_ref = weakref.ref(frozen_cycle)
+
+try:
+    import __pyston__
+    frozen = __pyston__.freeze() > 0
+except ImportError:
+    # The checks below print the same thing whether or not objects got frozen.
+    frozen = False
+
+# Frozen objects are out of the generations: they don't count towards collections, and the
+# collector doesn't know about them anymore.
+if frozen:
+    print gc.get_count()[1:]
+else:
+    print (0, 0)
+print any(o is l for o in gc.get_objects()) != frozen
+print any(o is frozen_cycle for o in gc.get_objects()) != frozen
+
+# And they never get collected, even when they become garbage.
+del frozen_cycle
+gc.collect()
+print (frozen_cycle_ref() is not None) == frozen
+
+d["d"] = [3]
+d["a"].append(d)
+del d["c"]
+print sorted(d.keys()), d["a"][:2], d["b"], hash(d["b"]) == hash("x" * 10)
+print sum(c.n for c in l)
+del l
+
+for i in xrange(1000):
+    Cycle()
+new_cycle = Cycle()
+new_cycle_ref = weakref.ref(new_cycle)
+del new_cycle
+gc.collect()
+print new_cycle_ref() is None
+print len(d["a"][2])
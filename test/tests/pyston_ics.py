@@ -0,0 +1,76 @@
+# Look up our own inline caches through the introspection API: one attribute
+# lookup that sees lots of classes, one that only ever sees one, and a binop
+# (whose class guards don't go through addClsGuard).
+
+import os
+
+def get_x(o):
+    return o.x
+
+def get_y(o):
+    return o.y
+
+def add(a, b):
+    return a + b
+
+GET_X_LINE = get_x.__code__.co_firstlineno + 1
+GET_Y_LINE = get_y.__code__.co_firstlineno + 1
+ADD_LINE = add.__code__.co_firstlineno + 1
+
+classes = [type("C%d" % i, (object,), {"x": i}) for i in xrange(150)]
+objs = [c() for c in classes]
+t = 0
+for i in xrange(3000):
+    t += get_x(objs[i % 150])
+print t
+
+class D(object):
+    y = 1
+
+d = D()
+t = 0
+for i in xrange(3000):
+    t += get_y(d)
+print t
+
+class N(object):
+    def __add__(self, other):
+        return 1
+
+n = N()
+t = 0
+for i in xrange(3000):
+    t += add(n, i)
+print t
+
+try:
+    import __pyston__
+except ImportError:
+    __pyston__ = None
+
+def sites(lineno):
+    return [ic for ic in __pyston__.getICs()
+            if ic["filename"] and os.path.basename(ic["filename"]) == os.path.basename(__file__)
+            and ic["lineno"] == lineno]
+
+if __pyston__:
+    for ic in __pyston__.getICs():
+        assert 0 <= ic["slots_used"] <= ic["slots"]
+        assert 0 <= ic["percent_megamorphic"] <= 100
+        assert ic["megamorphic"] == (ic["percent_megamorphic"] == 100)
+
+    # Either we gave up on the site, or we keep missing in it:
+    x_sites = sites(GET_X_LINE)
+    print bool(x_sites), any(ic["megamorphic"] or ic["times_slowpath"] > 100 for ic in x_sites)
+
+    y_sites = sites(GET_Y_LINE)
+    print bool(y_sites), any(ic["guarded_classes"] == ["D"] for ic in y_sites)
+    print any(ic["megamorphic"] for ic in y_sites)
+
+    add_sites = sites(ADD_LINE)
+    print bool(add_sites), any("N" in ic["guarded_classes"] for ic in add_sites)
+else:
+    print True, True
+    print True, True
+    print False
+    print True, True
@@ -0,0 +1,66 @@
+# Make a function hot enough to get jitted, and check that the compiles show up
+# in the jit event log (both in memory and in the JSON-lines file).
+
+import json
+import os
+import tempfile
+
+def hot(n):
+    t = 0
+    for i in xrange(n):
+        t += i % 7
+    return t
+
+try:
+    import __pyston__
+except ImportError:
+    __pyston__ = None
+
+fd, path = tempfile.mkstemp()
+os.close(fd)
+try:
+    if __pyston__:
+        __pyston__.getJitEvents(True)
+        __pyston__.setJitEventLog(path)
+
+    t = 0
+    for i in xrange(2000):
+        t += hot(100)
+    print t
+
+    if __pyston__:
+        __pyston__.setJitEventLog(None)
+        events = __pyston__.getJitEvents()
+    else:
+        events = [{"time": 0.0, "tier": "bjit", "effort": 0, "reason": "tierup", "name": "hot",
+                   "filename": __file__, "firstlineno": 8, "block": 0, "ir_size": 1, "compile_us": 0,
+                   "code_size": 1, "object_cache_hit": False}]
+        with open(path, "w") as f:
+            for e in events:
+                f.write(json.dumps(e) + "\n")
+
+    mine = [e for e in events if e["name"] == "hot"]
+    print len(mine) > 0
+    print all(e["tier"] in ("bjit", "llvm") for e in events)
+    print all(e["code_size"] > 0 and e["compile_us"] >= 0 for e in events)
+    print all((e["block"] is None) == (e["tier"] == "llvm") for e in events)
+    print sorted(mine[0].keys())
+
+    with open(path) as f:
+        logged = [json.loads(l) for l in f]
+    print len(logged) == len(events), [e["name"] for e in logged] == [e["name"] for e in events]
+finally:
+    os.unlink(path)
+
+if __pyston__:
+    totals = __pyston__.getJitTotals()
+    print sorted(totals), totals["bjit"]["num_compiles"] > 0
+    print __pyston__.getJitEvents(True) == events, __pyston__.getJitEvents()
+    try:
+        __pyston__.setJitEventLog("/nonexistent_dir/log")
+    except IOError as e:
+        print "IOError", e.errno
+else:
+    print ["bjit", "llvm"], True
+    print True, []
+    print "IOError", 2
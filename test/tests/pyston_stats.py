@@ -0,0 +1,86 @@
+# Snapshot the runtime stats (as a dict and as an exported file) while other
+# threads are bumping them, and check that nothing gets lost when they exit.
+
+import os
+import struct
+import tempfile
+import threading
+
+def work(n):
+    class C(object):
+        pass
+    t = 0
+    for i in xrange(n):
+        c = C()
+        c.x = i
+        t += c.x
+        try:
+            raise ValueError()
+        except ValueError:
+            pass
+    return t
+
+try:
+    import __pyston__
+except ImportError:
+    __pyston__ = None
+
+def getStats():
+    if __pyston__:
+        return __pyston__.getStats()
+    return {"num_fake": 0}
+
+before = getStats()
+print type(before) is dict, all(v >= 0 for v in before.values())
+
+threads = [threading.Thread(target=work, args=(2000,)) for i in xrange(4)]
+for t in threads:
+    t.start()
+during = getStats()
+for t in threads:
+    t.join()
+after = getStats()
+
+# The shards of the exited threads got folded in, so no counter went backwards:
+print all(after.get(k, 0) >= v for k, v in during.items())
+print all(after.get(k, 0) >= v for k, v in before.items())
+
+if __pyston__:
+    __pyston__.clearStats()
+cleared = getStats()
+print all(cleared.get(k, 0) <= v for k, v in after.items())
+
+fd, path = tempfile.mkstemp()
+os.close(fd)
+try:
+    for i in xrange(2):
+        if __pyston__:
+            __pyston__.exportStats(path)
+            expected = __pyston__.getStats()
+        else:
+            with open(path, "wb") as f:
+                f.write(struct.pack("=8sIIIIQQ", "PYSTATS\0", 1, 2, 1, 128, os.getpid(), 0))
+                f.write(struct.pack("=Q120s", 0, "num_fake"))
+            expected = getStats()
+        work(100)
+
+        with open(path, "rb") as f:
+            data = f.read()
+        magic, version, seq, num_entries, entry_size, pid, ts = struct.unpack_from("=8sIIIIQQ", data)
+        print magic.rstrip("\0"), version, seq % 2, entry_size, pid == os.getpid()
+        entries = {}
+        for j in xrange(num_entries):
+            value, name = struct.unpack_from("=Q120s", data, 40 + j * entry_size)
+            entries[name.rstrip("\0")] = value
+        print set(entries) == set(expected)
+        print all(entries[k] <= expected[k] for k in entries if not k.startswith("us_") and not k.startswith("_init_us_"))
+finally:
+    os.unlink(path)
+
+if __pyston__:
+    try:
+        __pyston__.exportStats("/nonexistent_dir/stats")
+    except OSError as e:
+        print "OSError", e.errno
+else:
+    print "OSError", 2
@@ -0,0 +1,35 @@
+# run_args: -n
+# The llvm tier's refcount pass should cancel out increfs on the way into a block that get decref'd again before
+# anything could observe the reference.
+# statcheck: noninit_count('num_irgen_refcount_ops_elided') >= 2
+
+class C(object):
+    def __init__(self):
+        self.a = 1
+        self.b = 2
+
+def f(n, o):
+    t = 0
+    for i in xrange(n):
+        x = o.a
+        y = o.b
+        if i % 3:
+            t += x
+        else:
+            t -= y
+        if i % 5 == 0:
+            t = t + x * y
+    return t
+
+print f(100000, C())
+
+def g(l):
+    total = 0
+    for x in l:
+        if x:
+            total += x
+        else:
+            total -= 1
+    return total
+
+print g(range(50000))
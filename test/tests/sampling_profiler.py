@@ -0,0 +1,61 @@
+# Run the sampling profiler over some CPU-bound code and check that the
+# collapsed stacks it reports point at the functions that were running.
+
+import threading
+import time
+
+def spin(n):
+    t = 0
+    for i in xrange(n):
+        t += i % 7
+    return t
+
+def outer():
+    end = time.time() + 0.3
+    while time.time() < end:
+        spin(10000)
+
+try:
+    import __pyston__
+except ImportError:
+    __pyston__ = None
+
+if __pyston__:
+    __pyston__.startProfiler(1000)
+outer()
+if __pyston__:
+    __pyston__.stopProfiler()
+    profile = __pyston__.getProfile(True)
+    lines = [l for l in profile.splitlines() if not l.startswith("[")]
+    total = 0
+    found = False
+    for l in lines:
+        stack, count = l.rsplit(" ", 1)
+        total += int(count)
+        frames = stack.split(";")
+        if any(f.startswith("outer (") for f in frames) and frames[-1].startswith("spin ("):
+            found = True
+    print total > 0, found
+    print __pyston__.getProfile(False) == ""
+else:
+    print True, True
+    print True
+
+# A thread with a deep stack fills its ring quickly; it has to get drained even though the main thread is blocked
+# in join() the whole time.
+def deep(d):
+    if d:
+        return deep(d - 1)
+    outer()
+
+if __pyston__:
+    __pyston__.startProfiler(1000)
+t = threading.Thread(target=deep, args=(50,))
+t.start()
+t.join()
+if __pyston__:
+    __pyston__.stopProfiler()
+    profile = __pyston__.getProfile(True)
+    print "[dropped]" not in profile, "spin (" in profile
+else:
+    print True, True
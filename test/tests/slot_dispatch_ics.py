@@ -0,0 +1,104 @@
+# Python-defined special methods reached through the C slots (dict/set operations,
+# operator.*, sum() etc), including changing them after the slot has been called.
+
+import operator
+
+class K(object):
+    def __init__(self, n):
+        self.n = n
+    def __hash__(self):
+        return self.n % 7
+    def __eq__(self, other):
+        return isinstance(other, K) and self.n == other.n
+
+d = {}
+for i in xrange(1000):
+    d[K(i % 50)] = i
+print len(d), d[K(3)], K(3) in d, K(51) in d
+print len(set(K(i) for i in xrange(100)))
+
+K.__hash__ = lambda self: 0
+print len(set(K(i) for i in xrange(100)))
+
+class K2(K):
+    def __hash__(self):
+        return "not an int"
+try:
+    hash(K2(1))
+except TypeError as e:
+    print "TypeError"
+
+class V(object):
+    def __init__(self, n):
+        self.n = n
+    def __add__(self, other):
+        if isinstance(other, V):
+            return V(self.n + other.n)
+        return NotImplemented
+    def __radd__(self, other):
+        return V(self.n + other)
+    def __neg__(self):
+        return V(-self.n)
+    def __lt__(self, other):
+        return self.n < other.n
+
+print sum([V(i) for i in xrange(100)]).n
+print operator.add(V(1), V(2)).n, operator.neg(V(5)).n
+print sorted([V(3), V(1), V(2)])[0].n
+V.__neg__ = lambda self: V(100)
+print operator.neg(V(5)).n
+
+class S(object):
+    def __init__(self):
+        self.d = {}
+    def __getitem__(self, k):
+        return self.d[k]
+    def __setitem__(self, k, v):
+        self.d[k] = v
+    def __delitem__(self, k):
+        del self.d[k]
+    def __len__(self):
+        return len(self.d)
+    def __contains__(self, k):
+        return k in self.d
+
+s = S()
+for i in xrange(100):
+    operator.setitem(s, i, i * i)
+print len(s), operator.getitem(s, 9), operator.contains(s, 9), operator.contains(s, 1000)
+for i in xrange(50):
+    operator.delitem(s, i)
+print len(s)
+try:
+    operator.getitem(s, 0)
+except KeyError:
+    print "KeyError"
+
+class Empty(object):
+    pass
+try:
+    operator.neg(Empty())
+except TypeError:
+    print "TypeError"
+
+# mp_subscript from C code: %-formatting looks the keys up with PyObject_GetItem.
+s = S()
+s["a"] = 1
+s["b"] = "x"
+for i in xrange(100):
+    r = "%(a)d %(b)s" % s
+print r
+
+# A rich comparison method whose lookup fails counts as not implemented, without leaking the error.
+class BadDescr(object):
+    def __get__(self, obj, cls):
+        raise AttributeError("no __eq__ here")
+
+class C(object):
+    __eq__ = BadDescr()
+
+c = C()
+l = [1, "a", c]
+for i in xrange(100):
+    r = (l.index(c), c in l, [C()].count(c))
+print r
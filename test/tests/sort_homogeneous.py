@@ -0,0 +1,31 @@
+# list.sort() uses specialized comparisons when all keys are ints, floats or strs.
+
+import random
+random.seed(12345)
+
+l = [random.randrange(-1000, 1000) for i in xrange(500)]
+print sorted(l)[:10], sorted(l, reverse=True)[:10]
+
+l = [random.random() * 100 - 50 for i in xrange(500)]
+print sorted(l) == sorted(l, cmp=lambda a, b: cmp(a, b))
+
+print sorted([3.0, float('nan'), 1.0, 2.0])[1:]
+print sorted(["b", "a\0b", "a", "\xff", "a\0", "ab", ""])
+
+# Mixed types fall back to the generic comparison.
+print sorted([3, 2.5, 1L, True, "x", 0])
+
+class I(int):
+    def __lt__(self, other):
+        return int(self) > int(other)
+print sorted([I(1), I(3), I(2)])
+
+# Key sorts compare the keys, and stay stable.
+records = [(random.randrange(10), i) for i in xrange(200)]
+by_key = sorted(records, key=lambda r: r[0])
+print by_key == sorted(records, key=lambda r: r[0], cmp=lambda a, b: cmp(a, b))
+print all(by_key[i][1] < by_key[i + 1][1] for i in xrange(len(by_key) - 1) if by_key[i][0] == by_key[i + 1][0])
+print sorted(records, key=lambda r: -r[0], reverse=True)[:5]
+print sorted(["bb", "a", "ccc", "dd"], key=len)
+print sorted(["bb", "a", "ccc", "dd"], key=lambda s: s[::-1])
+print sorted([1.5, 0.5, 2.5], key=lambda f: -f)
@@ -0,0 +1,66 @@
+# `s += x` on a local can append to the string in place; make sure that is never observable.
+# statcheck: noninit_count('num_str_inplace_concat') >= 1000
+# statcheck: noninit_count('slowpath_augbinop') <= 2000
+
+def build(n):
+    s = ""
+    for i in xrange(n):
+        s += str(i)
+        s += ","
+    return s
+
+def aliased(n):
+    s = "start"
+    saved = []
+    for i in xrange(n):
+        t = s
+        s += "x"
+        saved.append(t)
+    return s, saved[:3], saved[-1]
+
+def self_concat():
+    s = "ab"
+    for i in xrange(5):
+        s += s
+    return s
+
+def mixed():
+    s = "abc"
+    for i in xrange(3):
+        s += u"d"
+    for i in xrange(3):
+        s += "e"
+    return s, type(s)
+
+def in_dict(n):
+    d = {}
+    s = ""
+    for i in xrange(n):
+        s += "y"
+        d[s] = i
+    return len(d), d["yyy"]
+
+for n in (0, 1, 10, 1000):
+    r = build(n)
+    print len(r), r[-10:]
+
+# Everything that isn't a str still goes through the augbinop IC.
+def accumulate(n):
+    t = 0
+    f = 0.0
+    for i in xrange(n):
+        t += i
+        f += 0.5
+    return t, f
+print accumulate(10000)
+
+print aliased(100)
+print self_concat()
+print mixed()
+print in_dict(100)
+
+try:
+    s = "a"
+    s += 1
+except TypeError as e:
+    print e
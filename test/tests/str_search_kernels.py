@@ -0,0 +1,16 @@
+# Exercise the vectorized byte-string search paths across block boundaries.
+
+for n in (0, 1, 15, 16, 17, 31, 32, 33, 100):
+    s = "ab" * n + "xyz" + "\xff" * n
+    print n, s.find("x"), s.rfind("b"), s.count("a"), s.count("ab"), s.find("yz"), s.find("zz"), "xyz" in s
+    print s.find("ab" * 5 + "x"), s.count("b\xff"), s.count("\xff"), s.replace("ab", "-")[:20]
+    print s.find("ab" * 20), s.count("a", 3, 40)
+
+text = ("word\tother  words\x0bhere\x0cand\rthere\n" * 7) + "x" * 40 + " \x85tail"
+print text.split()
+print text.split(None, 3)
+print text.splitlines()
+print text.splitlines(True)
+print bytearray(text).split()
+print bytearray(text).splitlines()
+print ("a" * 40 + "\r\n" + "b" * 40).splitlines()
@@ -0,0 +1,71 @@
+# sys.setprofile / sys.settrace and cProfile, including for code that already got jitted.
+
+import sys
+
+def g(x):
+    return x * 2
+
+def f(n):
+    t = 0
+    for i in xrange(n):
+        t += g(i)
+    return t
+
+# warm up the jit tiers first
+for i in xrange(100):
+    f(200)
+
+events = []
+def prof(frame, event, arg):
+    # CPython also reports calls to builtins
+    if event in ("call", "return"):
+        events.append((event, frame.f_code.co_name))
+
+sys.setprofile(prof)
+print sys.getprofile() is prof
+f(3)
+sys.setprofile(None)
+print sys.getprofile()
+print events
+
+def gen():
+    yield 1
+    yield 2
+
+events = []
+sys.setprofile(prof)
+l = list(gen())
+sys.setprofile(None)
+print l, events
+
+def raiser():
+    raise ValueError()
+
+def catcher():
+    try:
+        raiser()
+    except ValueError:
+        pass
+    return 5
+
+events = []
+def trace(frame, event, arg):
+    if event != "line":
+        events.append((event, frame.f_code.co_name, type(arg).__name__))
+    return trace
+
+sys.settrace(trace)
+catcher()
+sys.settrace(None)
+print sys.gettrace()
+for e in events:
+    print e
+
+import cProfile
+p = cProfile.Profile()
+p.enable()
+f(10)
+p.disable()
+for entry in p.getstats():
+    if not isinstance(entry.code, str) and entry.code.co_name in ("f", "g"):
+        print entry.code.co_name, entry.callcount
@@ -0,0 +1,33 @@
+# Tuples of every freelist-able length created from jitted code and *args packing,
+# kept alive across collections and recycled through the freelists.
+
+import gc
+
+def make(i):
+    return [(), (i,), (i, i + 1), (i, i + 1, i + 2), (i, i, i, i), (i,) * 5,
+            (i, 1, 2, 3, 4, 5), (i, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18),
+            (i, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20)]
+
+def packed(*args):
+    return args
+
+keep = []
+total = 0
+for i in xrange(3000):
+    ts = make(i)
+    total += sum(len(t) for t in ts)
+    total += len(packed(i)) + len(packed(i, i)) + len(packed(1, 2, 3, 4, 5, 6))
+    if i % 100 == 0:
+        keep.append(ts)
+        gc.collect()
+print total
+print len(keep), keep[-1][3], keep[-1][-1][-1]
+print sum(t[0] for ts in keep for t in ts if t)
+
+# Tuples that are part of a cycle have to be tracked by the gc:
+class C(object):
+    pass
+for i in xrange(1000):
+    c = C()
+    c.t = (c, i)
+print gc.collect() >= 0
@@ -0,0 +1,51 @@
+# Tuple assignments that never let the intermediate tuple escape, run often enough to get
+# into the baseline jit.
+
+def fib(n):
+    a, b = 0, 1
+    for i in xrange(n):
+        a, b = b, a + b
+    return a
+
+print fib(10), fib(1000) % 1000007
+
+def swap(n):
+    a, b, c = 1, 2, 3
+    for i in xrange(n):
+        a, b, c = c, a, b
+    return a, b, c
+
+print swap(10000), swap(10001)
+
+def same_targets(n):
+    l = [0]
+    x = 5
+    for i in xrange(n):
+        l[0], x = x, i
+    return l, x
+
+print same_targets(5000)
+
+def escapes(n):
+    for i in xrange(n):
+        t = a, b = i, -i
+    return t, a, b
+
+print escapes(3000)
+
+def bad_count():
+    try:
+        a, b = 1, 2, 3
+    except ValueError as e:
+        print e
+bad_count()
+
+def plain_tuples(n):
+    l = []
+    for i in xrange(n):
+        t = (i, i + 1)
+        l.append(t)
+        a, b = t
+    return len(l), l[-1], a, b, (a, b)
+
+print plain_tuples(5000)
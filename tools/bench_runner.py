@@ -0,0 +1,354 @@
+#!/usr/bin/env python
+# Copyright (c) 2014-2016 Dropbox, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Runs benchmarks in fresh processes and reports, separately:
+# - the time to first result: from spawning the process to the end of the first iteration, ie including startup and
+#   the first round of compiling;
+# - the warmup curve: the time of every iteration, averaged over the processes, plus what the JITs compiled in it;
+# - the steady-state time per iteration, with a 95% confidence interval across processes.
+#
+# Every process runs the benchmark script several times (a fresh module dict each time, same code object, so the
+# JITed code gets reused).  The steady state starts after the last iteration in which either JIT compiled anything
+# (or after the first half of the iterations if the interpreter isn't Pyston or never stops compiling), and every
+# process contributes one sample: its mean steady-state iteration time.  Iterations of one process aren't independent
+# samples, but processes are.
+#
+# With --save the results get written out as JSON; with --baseline they get compared against such a file, and a
+# difference only gets called out if it is statistically significant (Welch's t-test at 95%).
+#
+# Usage: bench_runner.py -R ./pyston [-n PROCS] [-i ITERATIONS] [--save results.json] [--baseline old.json]
+#                        [benchmarks...]
+
+from __future__ import division
+
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+BASE_DIR = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+BENCH_DIR = os.path.join(BASE_DIR, "minibenchmarks")
+
+# Self-contained ones that run in a few seconds each:
+DEFAULT_BENCHMARKS = ["richards", "nbody_med", "fannkuch_med", "deltablue", "fasta", "raytrace", "spectral_norm"]
+
+# Collected from __pyston__.getStats() at the end of every process, if they exist:
+STATS_TO_COLLECT = ["num_deopt", "num_osr_exits", "num_osr_compiles", "reopts", "num_jit_objectcache_hits",
+                    "num_jit_objectcache_misses", "us_compiling", "us_compiling_jitting"]
+
+RESULTS_VERSION = 1
+
+# Two-sided 95% critical values of Student's t distribution, by degrees of freedom:
+T_TABLE = [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+           2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042]
+
+def t_critical(df):
+    if df < 1:
+        return float("inf")
+    if df > len(T_TABLE):
+        return 1.96
+    return T_TABLE[int(df) - 1]
+
+def mean(l):
+    return sum(l) / len(l)
+
+def stdev(l):
+    if len(l) < 2:
+        return 0.0
+    m = mean(l)
+    return math.sqrt(sum((x - m) ** 2 for x in l) / (len(l) - 1))
+
+def confidence_interval(l):
+    """ Returns (mean, half-width of the 95% confidence interval). """
+    if len(l) < 2:
+        return mean(l), float("inf")
+    return mean(l), t_critical(len(l) - 1) * stdev(l) / math.sqrt(len(l))
+
+def welch_significant(a, b):
+    """ Whether the means of the two samples differ at the 95% level. """
+    if len(a) < 2 or len(b) < 2:
+        return False
+    va = stdev(a) ** 2 / len(a)
+    vb = stdev(b) ** 2 / len(b)
+    if va + vb == 0:
+        return mean(a) != mean(b)
+    t = abs(mean(a) - mean(b)) / math.sqrt(va + vb)
+    df = (va + vb) ** 2 / ((va ** 2 / (len(a) - 1) if va else 0) + (vb ** 2 / (len(b) - 1) if vb else 0))
+    return t > t_critical(df)
+
+
+# Child side: runs under the interpreter that's being measured.
+
+def get_pyston():
+    try:
+        import __pyston__
+        return __pyston__
+    except ImportError:
+        return None
+
+def jit_compile_state(pyston):
+    if not pyston or not hasattr(pyston, "getJitTotals"):
+        return None
+    totals = pyston.getJitTotals()
+    return dict((tier, (t["num_compiles"], t["compile_us"])) for tier, t in totals.items())
+
+def collect_stats(pyston):
+    if not pyston:
+        return None
+    rtn = {}
+    if hasattr(pyston, "getStats"):
+        stats = pyston.getStats()
+        for name in STATS_TO_COLLECT:
+            if name in stats:
+                rtn[name] = stats[name]
+    if hasattr(pyston, "getJitTotals"):
+        rtn["jit"] = pyston.getJitTotals()
+    if hasattr(pyston, "getICs"):
+        ics = pyston.getICs()
+        rtn["ics"] = {
+            "num": len(ics),
+            "megamorphic": sum(1 for ic in ics if ic["megamorphic"]),
+            "times_slowpath": sum(ic["times_slowpath"] for ic in ics),
+        }
+    return rtn
+
+def run_child(path, iterations, spawn_time, output):
+    pyston = get_pyston()
+
+    code = compile(open(path).read(), path, "exec")
+    bench_dir = os.path.dirname(path)
+    os.chdir(bench_dir)
+    sys.path.insert(0, bench_dir)
+    sys.argv = [path]
+
+    real_stdout = sys.stdout
+    devnull = open(os.devnull, "w")
+
+    times = []
+    compiles = []
+    first_result = None
+    prev_state = jit_compile_state(pyston)
+    for i in xrange(iterations):
+        g = {"__name__": "__main__", "__file__": path, "__builtins__": __builtins__}
+        sys.stdout = devnull
+        start = time.time()
+        try:
+            exec code in g
+        finally:
+            sys.stdout = real_stdout
+        end = time.time()
+
+        times.append(end - start)
+        if first_result is None:
+            first_result = end - spawn_time
+
+        state = jit_compile_state(pyston)
+        if state is not None:
+            compiles.append(dict((tier, {"num_compiles": state[tier][0] - prev_state[tier][0],
+                                         "compile_us": state[tier][1] - prev_state[tier][1]})
+                                 for tier in state))
+        prev_state = state
+
+    with open(output, "w") as f:
+        json.dump({"times": times, "first_result": first_result, "compiles": compiles or None,
+                   "stats": collect_stats(pyston)}, f)
+
+
+# Parent side.
+
+def steady_state_start(run):
+    """ The first iteration that is part of the steady state. """
+    n = len(run["times"])
+    default = n // 2
+    if not run["compiles"]:
+        return default
+    last_compiling = -1
+    for i, c in enumerate(run["compiles"]):
+        if any(t["num_compiles"] for t in c.values()):
+            last_compiling = i
+    # If we're still compiling in the last quarter, there is no real steady state; just take the second half:
+    if last_compiling + 1 > n - max(2, n // 4):
+        return default
+    return last_compiling + 1
+
+def run_benchmark(interpreter, interp_args, path, procs, iterations, time_limit, verbose):
+    runs = []
+    failures = 0
+    for p in xrange(procs):
+        fd, output = tempfile.mkstemp(suffix=".json")
+        os.close(fd)
+        try:
+            args = [interpreter] + interp_args + [os.path.abspath(__file__), "--child", path, str(iterations),
+                                                  repr(time.time()), output]
+            # stderr goes to a file rather than a pipe: nobody reads a pipe while we wait, so a chatty child could
+            # fill it up and block forever.
+            with open(os.devnull, "w") as devnull, tempfile.TemporaryFile() as errf:
+                proc = subprocess.Popen(args, stdout=devnull, stderr=errf)
+                deadline = time.time() + time_limit
+                while proc.poll() is None and time.time() < deadline:
+                    time.sleep(0.01)
+                if proc.poll() is None:
+                    proc.kill()
+                    proc.wait()
+                    print >>sys.stderr, "%s: timed out after %ds" % (os.path.basename(path), time_limit)
+                    failures += 1
+                    continue
+                errf.seek(0)
+                err = errf.read()
+            if proc.returncode != 0:
+                print >>sys.stderr, "%s: exited with code %d:\n%s" % (os.path.basename(path), proc.returncode, err)
+                failures += 1
+                continue
+            with open(output) as f:
+                run = json.load(f)
+        finally:
+            os.unlink(output)
+
+        run["steady_start"] = steady_state_start(run)
+        steady = run["times"][run["steady_start"]:]
+        run["steady_mean"] = mean(steady) if steady else None
+        runs.append(run)
+        if verbose:
+            print "  process %d: first result %.3fs, steady state from iteration %d: %.4fs/iteration" % (
+                p, run["first_result"], run["steady_start"], run["steady_mean"])
+    return runs, failures
+
+def summarize(runs):
+    steady = [r["steady_mean"] for r in runs if r["steady_mean"] is not None]
+    first = [r["first_result"] for r in runs]
+    n_iters = min(len(r["times"]) for r in runs)
+    curve = [mean([r["times"][i] for r in runs]) for i in xrange(n_iters)]
+    summary = {
+        "steady_state": confidence_interval(steady) if steady else None,
+        "steady_samples": steady,
+        "first_result": confidence_interval(first),
+        "warmup_curve": curve,
+        "steady_start": [r["steady_start"] for r in runs],
+    }
+    if all(r["compiles"] for r in runs):
+        summary["compiles_per_iteration"] = [
+            dict((tier, mean([r["compiles"][i][tier]["num_compiles"] for r in runs])) for tier in runs[0]["compiles"][i])
+            for i in xrange(n_iters)]
+    return summary
+
+def format_ci(ci):
+    if ci is None:
+        return "n/a"
+    m, h = ci
+    if m == 0 or math.isinf(h):
+        return "%.4fs" % m
+    return "%.4fs +- %.1f%%" % (m, 100.0 * h / m)
+
+def print_summary(name, summary):
+    print "%s:" % name
+    print "  time to first result: %s" % format_ci(summary["first_result"])
+    print "  warmup curve:         %s" % " ".join("%.3f" % t for t in summary["warmup_curve"])
+    if "compiles_per_iteration" in summary:
+        print "  compiles/iteration:   %s" % " ".join("%g" % sum(c.values()) for c in summary["compiles_per_iteration"])
+    print "  steady state:         %s per iteration (from iteration %s)" % (
+        format_ci(summary["steady_state"]), "/".join(str(s) for s in summary["steady_start"]))
+
+def compare(results, baseline):
+    print
+    print "Comparison against the baseline (steady state, 95% confidence):"
+    ratios = []
+    for name in sorted(results["benchmarks"]):
+        new = results["benchmarks"][name]["summary"]
+        old = baseline["benchmarks"].get(name, {}).get("summary")
+        if not old or not old["steady_samples"] or not new["steady_samples"]:
+            print "  %-16s no baseline" % name
+            continue
+        ratio = mean(new["steady_samples"]) / mean(old["steady_samples"])
+        ratios.append(ratio)
+        if welch_significant(new["steady_samples"], old["steady_samples"]):
+            verdict = "slower" if ratio > 1 else "faster"
+        else:
+            verdict = "no significant change"
+        print "  %-16s %.4fs -> %.4fs  (%+.1f%%, %s)" % (name, mean(old["steady_samples"]),
+                                                       mean(new["steady_samples"]), 100.0 * (ratio - 1), verdict)
+    if ratios:
+        geomean = math.exp(sum(math.log(r) for r in ratios) / len(ratios))
+        print "  %-16s %+.1f%%" % ("geomean", 100.0 * (geomean - 1))
+
+def main():
+    parser = argparse.ArgumentParser(description="Runs benchmarks in fresh processes and reports warmup and "
+                                     "steady-state performance.")
+    parser.add_argument("-R", "--interpreter", default="./pyston", help="the interpreter to benchmark")
+    parser.add_argument("-a", "--extra-args", default=[], action="append", help="additional interpreter arguments")
+    parser.add_argument("-n", "--procs", type=int, default=5, help="number of fresh processes per benchmark")
+    parser.add_argument("-i", "--iterations", type=int, default=10, help="iterations per process")
+    parser.add_argument("-t", "--time-limit", type=int, default=600, help="time limit per process, in seconds")
+    parser.add_argument("--save", metavar="FILE", help="write the results to FILE as JSON")
+    parser.add_argument("--baseline", metavar="FILE",
+                        help="compare against results saved earlier (skipped if FILE doesn't exist)")
+    parser.add_argument("-v", "--verbose", action="store_true")
+    parser.add_argument("benchmarks", nargs="*",
+                        help="names of minibenchmarks or paths to scripts (default: %s)" % " ".join(DEFAULT_BENCHMARKS))
+    opts = parser.parse_args()
+
+    if opts.procs < 1 or opts.iterations < 1:
+        parser.error("need at least one process and one iteration")
+
+    benchmarks = []
+    for b in opts.benchmarks or DEFAULT_BENCHMARKS:
+        path = b if os.path.exists(b) else os.path.join(BENCH_DIR, b + ".py")
+        if not os.path.exists(path):
+            parser.error("no such benchmark: %s" % b)
+        benchmarks.append(os.path.abspath(path))
+
+    results = {"version": RESULTS_VERSION, "interpreter": opts.interpreter, "procs": opts.procs,
+               "iterations": opts.iterations, "benchmarks": {}}
+    failed = False
+    for path in benchmarks:
+        name = os.path.splitext(os.path.basename(path))[0]
+        runs, failures = run_benchmark(opts.interpreter, opts.extra_args, path, opts.procs, opts.iterations,
+                                       opts.time_limit, opts.verbose)
+        if failures:
+            failed = True
+        if not runs:
+            print "%s: all processes failed" % name
+            continue
+        summary = summarize(runs)
+        results["benchmarks"][name] = {"runs": runs, "summary": summary}
+        print_summary(name, summary)
+
+    if opts.save:
+        with open(opts.save, "w") as f:
+            json.dump(results, f, indent=1, sort_keys=True)
+
+    if opts.baseline:
+        if os.path.exists(opts.baseline):
+            with open(opts.baseline) as f:
+                baseline = json.load(f)
+            if baseline.get("version") != RESULTS_VERSION:
+                print >>sys.stderr, "%s: unsupported results version" % opts.baseline
+                failed = True
+            else:
+                compare(results, baseline)
+        else:
+            print
+            print "No baseline at %s yet; save one with --save (or the bench_save_baseline target)." % opts.baseline
+
+    sys.exit(1 if failed else 0)
+
+if __name__ == "__main__":
+    if len(sys.argv) == 6 and sys.argv[1] == "--child":
+        run_child(sys.argv[2], int(sys.argv[3]), float(sys.argv[4]), sys.argv[5])
+    else:
+        main()